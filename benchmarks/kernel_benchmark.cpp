@@ -0,0 +1,133 @@
+// kernel_benchmark.cpp
+//
+// Throughput of the payload kernels in include/ipc/simd_kernels.h, in GB/s:
+// CRC32C (slicing-by-8 and SSE4.2) and copies (memcpy and non-temporal AVX2 /
+// AVX-512 stores) for payloads from a few cache lines to well beyond the
+// last-level cache. Kernels the CPU does not support are reported as such.
+//
+//   kernel_benchmark [MiB per measurement] [--producer-cpus=N] [--fifo=PRIO] [--mlock]
+#include "ipc/runtime_config.h"
+#include "ipc/simd_kernels.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+constexpr std::size_t DEFAULT_MIB = 1024;
+static const std::size_t PAYLOAD_SIZES[] = {256, 4096, 64 * 1024, 1024 * 1024, 64 * 1024 * 1024};
+
+// Keeps results alive so the compiler cannot drop the measured calls
+static volatile uint32_t sink;
+
+static double gigabytes_per_second(std::size_t bytes, std::chrono::steady_clock::time_point start) {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return bytes / seconds / 1e9;
+}
+
+static double run_crc(ipc::Crc32cFunction kernel, const char* data, std::size_t size, std::size_t total) {
+    std::size_t rounds = total / size + 1;
+    uint32_t crc = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < rounds; ++i) {
+        crc = kernel(data, size, crc);
+    }
+    sink = crc;
+    return gigabytes_per_second(rounds * size, start);
+}
+
+static double run_copy(ipc::CopyFunction kernel, char* dst, const char* src, std::size_t size, std::size_t total) {
+    std::size_t rounds = total / size + 1;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < rounds; ++i) {
+        kernel(dst, src, size);
+    }
+    sink = static_cast<unsigned char>(dst[size - 1]);
+    return gigabytes_per_second(rounds * size, start);
+}
+
+static void print_row(const char* kernel, std::size_t size, double rate) {
+    std::cout << std::left << std::setw(20) << kernel << std::right << std::setw(12) << size;
+    if (rate < 0) {
+        std::cout << std::setw(12) << "n/a" << std::endl;
+    } else {
+        std::cout << std::setw(12) << std::fixed << std::setprecision(2) << rate << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    ipc::RuntimeConfig runtime("producer");
+    if (!runtime.parse_args(argc, argv) || !runtime.apply()) {
+        return 1;
+    }
+    argc = ipc::RuntimeConfig::strip_args(argc, argv);
+    std::size_t mib = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : DEFAULT_MIB;
+    if (mib == 0) {
+        std::cerr << "Usage: " << argv[0] << " [MiB per measurement]\n";
+        return 1;
+    }
+    const std::size_t total = mib * 1024 * 1024;
+    const ipc::SimdSupport& cpu = ipc::simd_support();
+
+    std::cout << "Machine: " << ipc::describe_machine() << "\n"
+              << "Placement: " << runtime.describe() << "\n"
+              << "Dispatch: " << ipc::simd_kernel_names() << "\n"
+              << "copy_payload() streams from: " << ipc::stream_copy_threshold() << " bytes\n"
+              << "Data per measurement: " << mib << " MiB\n\n";
+    std::cout << std::left << std::setw(20) << "kernel" << std::right << std::setw(12) << "bytes"
+              << std::setw(12) << "GB/s" << std::endl;
+
+    const std::size_t largest = PAYLOAD_SIZES[sizeof(PAYLOAD_SIZES) / sizeof(PAYLOAD_SIZES[0]) - 1];
+    std::vector<char> src(largest + 64), dst(largest + 64);
+    for (std::size_t i = 0; i < src.size(); ++i) {
+        src[i] = static_cast<char>(i * 131 + 7);
+    }
+    // Offset by one so the vector kernels also handle unaligned heads and tails
+    const char* source = src.data() + 1;
+    char* destination = dst.data() + 1;
+
+    bool ok = true;
+    const char check[] = "123456789";
+    if (ipc::crc32c_scalar(check, 9) != 0xE3069283u || ipc::crc32c(check, 9) != 0xE3069283u) {
+        std::cerr << "CRC32C check value mismatch\n";
+        ok = false;
+    }
+
+    for (std::size_t size : PAYLOAD_SIZES) {
+        print_row("crc32c scalar", size, run_crc(ipc::crc32c_scalar, source, size, total));
+#ifdef IPC_SIMD_X86
+        if (cpu.sse42) {
+            ok = ok && ipc::crc32c_sse42(source, size) == ipc::crc32c_scalar(source, size);
+            print_row("crc32c sse4.2", size, run_crc(ipc::crc32c_sse42, source, size, total));
+        } else {
+            print_row("crc32c sse4.2", size, -1);
+        }
+#endif
+    }
+    std::cout << "\n";
+
+    for (std::size_t size : PAYLOAD_SIZES) {
+        print_row("memcpy", size, run_copy(ipc::copy_scalar, destination, source, size, total));
+#ifdef IPC_SIMD_X86
+        if (cpu.avx2) {
+            print_row("stream avx2", size, run_copy(ipc::stream_copy_avx2, destination, source, size, total));
+            ok = ok && std::memcmp(destination, source, size) == 0;
+        } else {
+            print_row("stream avx2", size, -1);
+        }
+        if (cpu.avx512) {
+            print_row("stream avx512", size, run_copy(ipc::stream_copy_avx512, destination, source, size, total));
+            ok = ok && std::memcmp(destination, source, size) == 0;
+        } else {
+            print_row("stream avx512", size, -1);
+        }
+#endif
+    }
+
+    if (!ok) {
+        std::cerr << "A kernel produced a different result than the scalar version\n";
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+// logger_benchmark.cpp
+//
+// Measures the cost of one log call on the calling thread for the synchronous
+// log_message() in include/logger.h and for ASYNC_LOG in include/async_logger.h.
+// Both write to /dev/null so terminal speed does not skew the numbers. Time is
+// the calling thread's CPU time, so the async backend formatting on the same
+// core (or a sync writer blocked on the stream lock) is not charged to it.
+//
+//   logger_benchmark [calls] [threads]
+#include "logger.h"
+#include "async_logger.h"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+constexpr uint64_t DEFAULT_CALLS = 200000;
+constexpr uint64_t BURST = 4096; // Calls between async flushes, well below the ring size
+
+static double thread_cpu_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double run_sync(uint64_t calls) {
+    char message[96];
+    double start = thread_cpu_ns();
+    for (uint64_t i = 0; i < calls; ++i) {
+        snprintf(message, sizeof(message), "Wrote: %s to buffer index: %d (version: %llu)",
+                 "aVACVEbIli", static_cast<int>(i & 1), static_cast<unsigned long long>(i));
+        log_message(GREEN, message);
+    }
+    return (thread_cpu_ns() - start) / calls;
+}
+
+static double run_async(uint64_t calls) {
+    double total_ns = 0;
+    for (uint64_t done = 0; done < calls;) {
+        uint64_t burst = std::min(BURST, calls - done);
+        double start = thread_cpu_ns();
+        for (uint64_t i = 0; i < burst; ++i) {
+            ASYNC_LOG("Wrote: %s to buffer index: %d (version: %llu)",
+                      "aVACVEbIli", static_cast<int>(i & 1), static_cast<unsigned long long>(done + i));
+        }
+        total_ns += thread_cpu_ns() - start;
+        done += burst;
+        // Let the backend catch up outside the timed region
+        async_log::flush();
+    }
+    return total_ns / calls;
+}
+
+template <typename Fn>
+static double run_threads(unsigned threads, uint64_t calls, Fn fn) {
+    std::vector<double> per_thread(threads);
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([&per_thread, t, calls, fn]() { per_thread[t] = fn(calls); }));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double sum = 0;
+    for (double ns : per_thread) {
+        sum += ns;
+    }
+    return sum / threads;
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t calls = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : DEFAULT_CALLS;
+    unsigned threads = (argc > 2) ? static_cast<unsigned>(std::atoi(argv[2])) : 1;
+    if (calls == 0 || threads == 0) {
+        std::cerr << "Usage: " << argv[0] << " [calls] [threads]\n";
+        return 1;
+    }
+
+    std::ofstream null_stream("/dev/null");
+    std::streambuf* saved = std::cout.rdbuf(null_stream.rdbuf());
+    FILE* null_file = std::fopen("/dev/null", "w");
+    async_log::Logger::instance().set_output(null_file);
+
+    double sync_ns = run_threads(threads, calls, run_sync);
+    double async_ns = run_threads(threads, calls, run_async);
+
+    async_log::flush();
+    async_log::Logger::instance().set_output(stdout);
+    std::fclose(null_file);
+    std::cout.rdbuf(saved);
+    std::cout << std::setfill(' '); // log_message leaves the fill character set to '0'
+
+    std::cout << "Calls per thread: " << calls << ", threads: " << threads << "\n\n";
+    std::cout << std::left << std::setw(24) << "logger" << std::right << std::setw(14) << "cpu ns/call" << "\n";
+    std::cout << std::left << std::setw(24) << "log_message (sync)" << std::right << std::setw(14)
+              << std::fixed << std::setprecision(1) << sync_ns << "\n";
+    std::cout << std::left << std::setw(24) << "ASYNC_LOG" << std::right << std::setw(14)
+              << async_ns << "\n";
+    return 0;
+}
@@ -0,0 +1,257 @@
+// perf_gate.h
+//
+// Result reporting for perf_regression: collects the metrics of one run,
+// writes them as JSON and compares them against a stored baseline.
+#ifndef PERF_GATE_H
+#define PERF_GATE_H
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace perf {
+
+enum Better { LOWER, HIGHER };
+
+// Outcome of comparing a run with its baseline
+enum Verdict { PASSED, REGRESSED, SKIPPED };
+
+struct Metric {
+    std::string name;
+    double value;
+    std::string unit;
+    Better better;
+};
+
+/**
+ * @brief Flattens a JSON document into "a.b.c" -> scalar text.
+ *
+ * @details Only what Report::write() produces needs to be read back: objects,
+ *          strings, numbers, true/false/null. Arrays are rejected.
+ */
+class JsonReader {
+public:
+    explicit JsonReader(const std::string& text) : text_(text), pos_(0) {}
+
+    bool parse(std::map<std::string, std::string>& out) {
+        skip_space();
+        if (!value("", out)) {
+            return false;
+        }
+        skip_space();
+        return pos_ == text_.size();
+    }
+
+private:
+    void skip_space() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+            ++pos_;
+        }
+    }
+
+    bool consume(char c) {
+        skip_space();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    bool string(std::string& out) {
+        if (!consume('"')) {
+            return false;
+        }
+        out.clear();
+        while (pos_ < text_.size() && text_[pos_] != '"') {
+            if (text_[pos_] == '\\' && pos_ + 1 < text_.size()) {
+                ++pos_;
+            }
+            out += text_[pos_++];
+        }
+        return consume('"');
+    }
+
+    bool value(const std::string& path, std::map<std::string, std::string>& out) {
+        skip_space();
+        if (pos_ >= text_.size()) {
+            return false;
+        }
+        if (text_[pos_] == '{') {
+            ++pos_;
+            if (consume('}')) {
+                return true;
+            }
+            do {
+                std::string key;
+                if (!string(key) || !consume(':') || !value(path.empty() ? key : path + "." + key, out)) {
+                    return false;
+                }
+            } while (consume(','));
+            return consume('}');
+        }
+        if (text_[pos_] == '"') {
+            return string(out[path]);
+        }
+        std::size_t start = pos_;
+        while (pos_ < text_.size() && (std::isalnum(static_cast<unsigned char>(text_[pos_])) ||
+                                       text_[pos_] == '-' || text_[pos_] == '+' || text_[pos_] == '.')) {
+            ++pos_;
+        }
+        if (pos_ == start) {
+            return false;
+        }
+        out[path] = text_.substr(start, pos_ - start);
+        return true;
+    }
+
+    const std::string& text_;
+    std::size_t pos_;
+};
+
+/**
+ * @brief The metrics of one benchmark run and their comparison with a baseline.
+ *
+ * @details Baselines are result files of an earlier run. A metric fails when
+ *          it is worse than its baseline by more than `tolerance`, a fraction:
+ *          with 0.5, a latency may grow to 1.5x and a throughput may drop to
+ *          1/1.5 of the baseline. Metrics missing from the baseline are
+ *          reported but not gated, so a baseline can be trimmed to the stable
+ *          ones. Timings only compare on the machine that recorded them, so a
+ *          missing baseline or one from another machine skips the gate.
+ */
+class Report {
+public:
+    Report(const std::string& benchmark, const std::string& machine) : benchmark_(benchmark), machine_(machine) {}
+
+    void add_parameter(const std::string& name, uint64_t value) { parameters_.push_back(std::make_pair(name, value)); }
+
+    void add(const std::string& name, double value, const std::string& unit, Better better) {
+        Metric metric = {name, value, unit, better};
+        metrics_.push_back(metric);
+    }
+
+    bool write(const std::string& path) const {
+        std::ofstream out(path.c_str());
+        if (!out) {
+            std::cerr << "Cannot write " << path << "\n";
+            return false;
+        }
+        out << "{\n"
+            << "  \"benchmark\": \"" << escape(benchmark_) << "\",\n"
+            << "  \"machine\": \"" << escape(machine_) << "\",\n"
+            << "  \"parameters\": {";
+        for (std::size_t i = 0; i < parameters_.size(); ++i) {
+            out << (i ? ", " : "") << "\"" << parameters_[i].first << "\": " << parameters_[i].second;
+        }
+        out << "},\n  \"metrics\": {\n";
+        for (std::size_t i = 0; i < metrics_.size(); ++i) {
+            const Metric& m = metrics_[i];
+            out << "    \"" << m.name << "\": {\"value\": " << std::fixed << std::setprecision(1) << m.value
+                << ", \"unit\": \"" << m.unit << "\", \"better\": \"" << (m.better == LOWER ? "lower" : "higher")
+                << "\"}" << (i + 1 < metrics_.size() ? "," : "") << "\n";
+        }
+        out << "  }\n}\n";
+        return static_cast<bool>(out);
+    }
+
+    /**
+     * Prints every metric next to its baseline.
+     * @return REGRESSED if a gated metric regressed, or the baseline is
+     *         unreadable or was recorded with different parameters; SKIPPED if
+     *         there is no baseline or it was recorded on another machine
+     */
+    Verdict compare(const std::string& path, double tolerance) const {
+        std::ifstream in(path.c_str());
+        if (!in.is_open()) {
+            print();
+            std::cout << "No baseline at " << path << "; record one with the perf_baselines target\n";
+            return SKIPPED;
+        }
+        std::stringstream text;
+        text << in.rdbuf();
+        std::map<std::string, std::string> baseline;
+        if (!in || !JsonReader(text.str()).parse(baseline)) {
+            std::cerr << "Cannot read baseline " << path << "\n";
+            return REGRESSED;
+        }
+        if (baseline["machine"] != machine_) {
+            print();
+            std::cout << "Baseline " << path << " was recorded on " << baseline["machine"]
+                      << "; re-record it here with the perf_baselines target\n";
+            return SKIPPED;
+        }
+        bool ok = true;
+        for (std::size_t i = 0; i < parameters_.size(); ++i) {
+            const std::string& recorded = baseline["parameters." + parameters_[i].first];
+            if (std::strtoull(recorded.c_str(), nullptr, 10) != parameters_[i].second) {
+                std::cerr << "Baseline has " << parameters_[i].first << " = " << recorded << ", this run "
+                          << parameters_[i].second << "; refresh the baseline\n";
+                ok = false;
+            }
+        }
+
+        ok = table(&baseline, tolerance) && ok;
+        std::cout << "Tolerance: " << std::setprecision(0) << tolerance * 100 << "% worse than " << path << "\n";
+        return ok ? PASSED : REGRESSED;
+    }
+
+    /// Prints the metrics without comparing them.
+    void print() const { table(nullptr, 0.0); }
+
+    const std::vector<Metric>& metrics() const { return metrics_; }
+
+private:
+    // Prints one row per metric; false if one regressed against `baseline`
+    bool table(const std::map<std::string, std::string>* baseline, double tolerance) const {
+        bool ok = true;
+        std::cout << std::left << std::setw(28) << "metric" << std::right << std::setw(16) << "value"
+                  << std::setw(16) << "baseline" << std::setw(10) << "change" << "\n";
+        for (std::size_t i = 0; i < metrics_.size(); ++i) {
+            const Metric& m = metrics_[i];
+            std::cout << std::left << std::setw(28) << m.name << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(16) << m.value;
+            std::map<std::string, std::string>::const_iterator found;
+            if (baseline == nullptr || (found = baseline->find("metrics." + m.name + ".value")) == baseline->end()) {
+                std::cout << std::setw(16) << "-" << std::setw(10) << "-" << (baseline ? "  (not gated)" : "") << "\n";
+                continue;
+            }
+            double reference = std::strtod(found->second.c_str(), nullptr);
+            double change = reference > 0 ? (m.value - reference) / reference * 100.0 : 0.0;
+            bool regressed = m.better == LOWER ? m.value > reference * (1.0 + tolerance)
+                                               : m.value * (1.0 + tolerance) < reference;
+            std::cout << std::setw(16) << reference << std::setw(9) << std::showpos << change << std::noshowpos
+                      << "%" << (regressed ? "  REGRESSION" : "") << "\n";
+            ok = ok && !regressed;
+        }
+        return ok;
+    }
+
+    static std::string escape(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+            }
+            out += c;
+        }
+        return out;
+    }
+
+    std::string benchmark_;
+    std::string machine_;
+    std::vector<std::pair<std::string, uint64_t>> parameters_;
+    std::vector<Metric> metrics_;
+};
+
+} // namespace perf
+
+#endif
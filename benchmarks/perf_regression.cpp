@@ -0,0 +1,538 @@
+// perf_regression.cpp
+//
+// Fixed-workload benchmarks registered with CTest as a performance gate. Each
+// workload runs a few times, keeps the best value of every metric, writes the
+// result as JSON and, given a baseline, fails if a metric got worse than the
+// baseline by more than the tolerance (see perf_gate.h). Without a baseline
+// recorded on this machine it exits with SKIP_EXIT_CODE, which CTest reports
+// as skipped.
+//
+//   perf_regression <shm_channel|process_mutex|queue|tcp_echo>
+//                   [--json=FILE] [--baseline=FILE] [--update-baseline]
+//                   [--tolerance=FRACTION] [--repeat=N] [--server=PATH] [--port=N]
+//
+// IPC_PERF_TOLERANCE in the environment overrides --tolerance.
+#include "perf_gate.h"
+#include "bounded_queue.h"
+#include "ipc/channel.h"
+#include "ipc/runtime_config.h"
+#include "ipc/shared_segment.h"
+#include "ipc/sync.h"
+#include <boost/interprocess/sync/interprocess_mutex.hpp>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <sched.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr int DEFAULT_REPEAT = 3;
+constexpr double DEFAULT_TOLERANCE = 0.5;
+constexpr int DEFAULT_PORT = 19092;
+constexpr int SKIP_EXIT_CODE = 77; // SKIP_RETURN_CODE of the CTest tests
+
+// Workload sizes; part of the result so a baseline of another size is refused
+constexpr uint64_t CHANNEL_STREAM_MESSAGES = 2000000;
+constexpr uint64_t CHANNEL_ROUND_TRIPS = 20000;
+constexpr uint64_t MUTEX_OPERATIONS = 1000000;
+constexpr uint64_t QUEUE_MESSAGES = 4000000;
+constexpr uint64_t TCP_ROUND_TRIPS = 10000;
+constexpr std::size_t TCP_MESSAGE_BYTES = 64;
+
+struct Options {
+    std::string workload;
+    std::string json;
+    std::string baseline;
+    std::string server;
+    bool update_baseline = false;
+    double tolerance = DEFAULT_TOLERANCE;
+    int repeat = DEFAULT_REPEAT;
+    int port = DEFAULT_PORT;
+};
+
+static uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t median(std::vector<uint64_t>& samples) {
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+static bool reap(pid_t pid) {
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// ---------------------------------------------------------------------------
+// Workloads. Each run adds its metrics to `report` and returns false if the
+// run itself failed (lost messages, a child crashed).
+// ---------------------------------------------------------------------------
+
+struct ChannelMessage {
+    uint64_t sequence;
+    uint64_t send_ns;
+    char payload[48];
+};
+
+typedef ipc::Channel<ChannelMessage, 1024, ipc::FutexWait> BenchChannel;
+
+struct ChannelSegment {
+    BenchChannel request;
+    BenchChannel reply;
+};
+
+// ipc::Channel between two processes: one-way streaming, then ping-pong
+static bool run_shm_channel(perf::Report& report) {
+    ipc::SharedSegment shared;
+    if (!shared.anonymous(sizeof(ChannelSegment))) {
+        return false;
+    }
+    ChannelSegment* segment = shared.as<ChannelSegment>();
+    segment->request.init();
+    segment->reply.init();
+
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork");
+        return false;
+    }
+    if (pid == 0) {
+        ChannelMessage message;
+        bool in_order = true;
+        for (uint64_t i = 0; i < CHANNEL_STREAM_MESSAGES; ++i) {
+            segment->request.pop(message);
+            in_order = in_order && message.sequence == i;
+        }
+        segment->reply.push(message); // Stream fully received
+        for (uint64_t i = 0; i < CHANNEL_ROUND_TRIPS; ++i) {
+            segment->request.pop(message);
+            segment->reply.push(message);
+        }
+        _exit(in_order ? 0 : 2);
+    }
+
+    ChannelMessage message;
+    std::memset(&message, 0, sizeof(message));
+    uint64_t start = now_ns();
+    for (uint64_t i = 0; i < CHANNEL_STREAM_MESSAGES; ++i) {
+        message.sequence = i;
+        segment->request.push(message);
+    }
+    segment->reply.pop(message);
+    double stream_seconds = (now_ns() - start) / 1e9;
+
+    std::vector<uint64_t> round_trips(CHANNEL_ROUND_TRIPS);
+    for (uint64_t i = 0; i < CHANNEL_ROUND_TRIPS; ++i) {
+        message.sequence = i;
+        message.send_ns = now_ns();
+        segment->request.push(message);
+        segment->reply.pop(message);
+        round_trips[i] = now_ns() - message.send_ns;
+    }
+    if (!reap(pid)) {
+        std::cerr << "shm_channel: consumer failed or received messages out of order\n";
+        return false;
+    }
+
+    report.add("stream_msgs_per_s", CHANNEL_STREAM_MESSAGES / stream_seconds, "msgs/s", perf::HIGHER);
+    report.add("round_trip_p50_ns", median(round_trips), "ns", perf::LOWER);
+    return true;
+}
+
+struct MutexSegment {
+    pthread_mutex_t mutex;
+    boost::interprocess::interprocess_mutex boost_mutex;
+    std::atomic<uint32_t> go;
+    uint64_t counter;
+};
+
+template <typename Lock, typename Unlock>
+static void increment(MutexSegment* segment, uint64_t operations, Lock lock, Unlock unlock) {
+    for (uint64_t i = 0; i < operations; ++i) {
+        lock();
+        ++segment->counter;
+        unlock();
+    }
+}
+
+// One mutex, alone and then shared by two processes: ns per lock/unlock pair
+template <typename Lock, typename Unlock>
+static bool measure_mutex(perf::Report& report, const std::string& prefix, MutexSegment* segment, Lock lock,
+                          Unlock unlock) {
+    segment->counter = 0;
+    uint64_t start = now_ns();
+    increment(segment, MUTEX_OPERATIONS, lock, unlock);
+    double uncontended = static_cast<double>(now_ns() - start) / MUTEX_OPERATIONS;
+
+    segment->counter = 0;
+    segment->go.store(0, std::memory_order_relaxed);
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork");
+        return false;
+    }
+    if (pid == 0) {
+        while (segment->go.load(std::memory_order_acquire) == 0) {
+            sched_yield();
+        }
+        increment(segment, MUTEX_OPERATIONS, lock, unlock);
+        _exit(0);
+    }
+    start = now_ns();
+    segment->go.store(1, std::memory_order_release);
+    increment(segment, MUTEX_OPERATIONS, lock, unlock);
+    bool ok = reap(pid);
+    double contended = static_cast<double>(now_ns() - start) / (2 * MUTEX_OPERATIONS);
+    if (!ok || segment->counter != 2 * MUTEX_OPERATIONS) {
+        std::cerr << prefix << ": counter is " << segment->counter << ", expected " << 2 * MUTEX_OPERATIONS << "\n";
+        return false;
+    }
+
+    report.add(prefix + "_uncontended_ns", uncontended, "ns/op", perf::LOWER);
+    report.add(prefix + "_contended_ns", contended, "ns/op", perf::LOWER);
+    return true;
+}
+
+// The two inter-process mutexes of the mutex-between-multiple-processes modules
+static bool run_process_mutex(perf::Report& report) {
+    ipc::SharedSegment shared;
+    if (!shared.anonymous(sizeof(MutexSegment))) {
+        return false;
+    }
+    // interprocess_mutex is not standard layout, so the mapping is cast directly
+    MutexSegment* segment = reinterpret_cast<MutexSegment*>(shared.data());
+    ipc::init_shared_mutex(&segment->mutex);
+    new (&segment->boost_mutex) boost::interprocess::interprocess_mutex();
+
+    bool ok = measure_mutex(report, "pthread", segment, [segment]() { pthread_mutex_lock(&segment->mutex); },
+                            [segment]() { pthread_mutex_unlock(&segment->mutex); });
+    ok = ok && measure_mutex(report, "boost", segment, [segment]() { segment->boost_mutex.lock(); },
+                             [segment]() { segment->boost_mutex.unlock(); });
+
+    pthread_mutex_destroy(&segment->mutex);
+    segment->boost_mutex.~interprocess_mutex();
+    return ok;
+}
+
+// BoundedQueue: uncontended hand-off cost, then one producer and one consumer thread
+static bool run_queue(perf::Report& report) {
+    std::unique_ptr<BoundedQueue<uint64_t, 1024>> queue(new BoundedQueue<uint64_t, 1024>());
+    uint64_t value = 0;
+    uint64_t start = now_ns();
+    for (uint64_t i = 0; i < QUEUE_MESSAGES; ++i) {
+        queue->push(i);
+        queue->pop(value);
+    }
+    double single_thread = static_cast<double>(now_ns() - start) / QUEUE_MESSAGES;
+
+    bool in_order = true;
+    start = now_ns();
+    std::thread consumer([&queue, &in_order]() {
+        uint64_t received;
+        for (uint64_t i = 0; i < QUEUE_MESSAGES; ++i) {
+            queue->pop(received);
+            in_order = in_order && received == i;
+        }
+    });
+    for (uint64_t i = 0; i < QUEUE_MESSAGES; ++i) {
+        queue->push(i);
+    }
+    consumer.join();
+    double seconds = (now_ns() - start) / 1e9;
+    if (!in_order) {
+        std::cerr << "queue: messages received out of order\n";
+        return false;
+    }
+
+    report.add("single_thread_ns", single_thread, "ns/op", perf::LOWER);
+    report.add("spsc_msgs_per_s", QUEUE_MESSAGES / seconds, "msgs/s", perf::HIGHER);
+    return true;
+}
+
+static bool write_all(int fd, const char* data, std::size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+static bool read_all(int fd, char* data, std::size_t len) {
+    while (len > 0) {
+        ssize_t n = read(fd, data, len);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+// Blocking one-connection echo, used when no --server is given
+static void echo_child(int listen_fd) {
+    int client_fd = accept(listen_fd, nullptr, nullptr);
+    if (client_fd == -1) {
+        _exit(1);
+    }
+    char buf[1024];
+    ssize_t n;
+    while ((n = read(client_fd, buf, sizeof(buf))) > 0) {
+        if (!write_all(client_fd, buf, static_cast<std::size_t>(n))) {
+            break;
+        }
+    }
+    _exit(0);
+}
+
+static pid_t start_server(const Options& options) {
+    int listen_fd = -1;
+    if (options.server.empty()) {
+        listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        int opt = 1;
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(options.port);
+        if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1 || listen(listen_fd, 1) == -1) {
+            perror("bind/listen");
+            close(listen_fd);
+            return -1;
+        }
+    }
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork");
+    } else if (pid == 0) {
+        if (listen_fd != -1) {
+            echo_child(listen_fd);
+        }
+        int null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        std::string port = std::to_string(options.port);
+        execl(options.server.c_str(), options.server.c_str(), port.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    if (listen_fd != -1) {
+        close(listen_fd);
+    }
+    return pid;
+}
+
+// Connects, retrying while an exec'd server is still starting up
+static int connect_loopback(int port, pid_t server) {
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    for (int attempt = 0; attempt < 500; ++attempt) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+            int opt = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+            return fd;
+        }
+        close(fd);
+        if (waitpid(server, nullptr, WNOHANG) == server) {
+            break;
+        }
+        usleep(10000);
+    }
+    std::cerr << "tcp_echo: cannot connect to the server on port " << port << "\n";
+    return -1;
+}
+
+// Request/response round trips of one small message over loopback TCP
+static bool run_tcp_echo(perf::Report& report, const Options& options) {
+    pid_t server = start_server(options);
+    if (server == -1) {
+        return false;
+    }
+    int fd = connect_loopback(options.port, server);
+    bool ok = fd != -1;
+
+    std::vector<uint64_t> round_trips(TCP_ROUND_TRIPS);
+    char request[TCP_MESSAGE_BYTES];
+    char response[TCP_MESSAGE_BYTES];
+    std::memset(request, 'x', sizeof(request));
+    uint64_t start = now_ns();
+    for (uint64_t i = 0; ok && i < TCP_ROUND_TRIPS; ++i) {
+        std::memcpy(request, &i, sizeof(i));
+        uint64_t sent = now_ns();
+        ok = write_all(fd, request, sizeof(request)) && read_all(fd, response, sizeof(response)) &&
+             std::memcmp(request, response, sizeof(request)) == 0;
+        round_trips[i] = now_ns() - sent;
+    }
+    double seconds = (now_ns() - start) / 1e9;
+    if (fd != -1) {
+        close(fd);
+    }
+    kill(server, SIGTERM);
+    waitpid(server, nullptr, 0);
+    if (!ok) {
+        std::cerr << "tcp_echo: echo failed or returned different bytes\n";
+        return false;
+    }
+
+    report.add("round_trip_p50_ns", median(round_trips), "ns", perf::LOWER);
+    report.add("round_trips_per_s", TCP_ROUND_TRIPS / seconds, "msgs/s", perf::HIGHER);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Harness
+// ---------------------------------------------------------------------------
+
+static bool run_once(const Options& options, perf::Report& report) {
+    if (options.workload == "shm_channel") {
+        return run_shm_channel(report);
+    }
+    if (options.workload == "process_mutex") {
+        return run_process_mutex(report);
+    }
+    if (options.workload == "queue") {
+        return run_queue(report);
+    }
+    return run_tcp_echo(report, options);
+}
+
+static void add_parameters(const Options& options, perf::Report& report) {
+    if (options.workload == "shm_channel") {
+        report.add_parameter("stream_messages", CHANNEL_STREAM_MESSAGES);
+        report.add_parameter("round_trips", CHANNEL_ROUND_TRIPS);
+    } else if (options.workload == "process_mutex") {
+        report.add_parameter("operations", MUTEX_OPERATIONS);
+    } else if (options.workload == "queue") {
+        report.add_parameter("messages", QUEUE_MESSAGES);
+    } else {
+        report.add_parameter("round_trips", TCP_ROUND_TRIPS);
+        report.add_parameter("message_bytes", TCP_MESSAGE_BYTES);
+    }
+}
+
+static bool parse_options(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 7, "--json=") == 0) {
+            options.json = arg.substr(7);
+        } else if (arg.compare(0, 11, "--baseline=") == 0) {
+            options.baseline = arg.substr(11);
+        } else if (arg == "--update-baseline") {
+            options.update_baseline = true;
+        } else if (arg.compare(0, 12, "--tolerance=") == 0) {
+            options.tolerance = std::atof(arg.c_str() + 12);
+        } else if (arg.compare(0, 9, "--repeat=") == 0) {
+            options.repeat = std::max(1, std::atoi(arg.c_str() + 9));
+        } else if (arg.compare(0, 9, "--server=") == 0) {
+            options.server = arg.substr(9);
+        } else if (arg.compare(0, 7, "--port=") == 0) {
+            options.port = std::atoi(arg.c_str() + 7);
+        } else if (options.workload.empty() && arg.compare(0, 2, "--") != 0) {
+            options.workload = arg;
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            return false;
+        }
+    }
+    if (const char* tolerance = std::getenv("IPC_PERF_TOLERANCE")) {
+        options.tolerance = std::atof(tolerance);
+    }
+    const char* workloads[] = {"shm_channel", "process_mutex", "queue", "tcp_echo"};
+    if (std::find(std::begin(workloads), std::end(workloads), options.workload) == std::end(workloads)) {
+        std::cerr << "Usage: " << argv[0] << " <shm_channel|process_mutex|queue|tcp_echo> [--json=FILE]"
+                  << " [--baseline=FILE] [--update-baseline] [--tolerance=FRACTION] [--repeat=N]"
+                  << " [--server=PATH] [--port=N]\n";
+        return false;
+    }
+    if (options.update_baseline && options.baseline.empty()) {
+        std::cerr << "--update-baseline needs --baseline=FILE\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        return 1;
+    }
+
+    // Keep the best value of each metric over the repetitions: noise from the
+    // rest of the machine only ever makes a run slower
+    std::vector<perf::Metric> best;
+    for (int run = 0; run < options.repeat; ++run) {
+        perf::Report attempt(options.workload, "");
+        if (!run_once(options, attempt)) {
+            return 1;
+        }
+        const std::vector<perf::Metric>& metrics = attempt.metrics();
+        if (best.empty()) {
+            best = metrics;
+            continue;
+        }
+        for (std::size_t i = 0; i < best.size(); ++i) {
+            bool better = metrics[i].better == perf::LOWER ? metrics[i].value < best[i].value
+                                                           : metrics[i].value > best[i].value;
+            if (better) {
+                best[i].value = metrics[i].value;
+            }
+        }
+    }
+
+    perf::Report report(options.workload, ipc::describe_machine());
+    add_parameters(options, report);
+    for (const perf::Metric& metric : best) {
+        report.add(metric.name, metric.value, metric.unit, metric.better);
+    }
+    std::cout << "Workload: " << options.workload << ", best of " << options.repeat << " runs\n"
+              << "Machine: " << ipc::describe_machine() << "\n";
+
+    if (!options.json.empty() && !report.write(options.json)) {
+        return 1;
+    }
+    if (options.update_baseline) {
+        report.print();
+        if (!report.write(options.baseline)) {
+            return 1;
+        }
+        std::cout << "Baseline written to " << options.baseline << "\n";
+        return 0;
+    }
+    if (options.baseline.empty()) {
+        report.print();
+        return 0;
+    }
+    switch (report.compare(options.baseline, options.tolerance)) {
+    case perf::PASSED:
+        return 0;
+    case perf::SKIPPED:
+        return SKIP_EXIT_CODE;
+    default:
+        return 1;
+    }
+}
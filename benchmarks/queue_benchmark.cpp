@@ -0,0 +1,155 @@
+// queue_benchmark.cpp
+//
+// In-process hand-off throughput: BoundedQueue (include/bounded_queue.h)
+// against the same bounded ring guarded by one std::mutex and two
+// std::condition_variables, the pattern producerConsumerDemo used to build on.
+// Each row runs P producers and P consumers (2P threads) through the blocking
+// push()/pop(); the single-thread row pushes and pops alternately.
+//
+//   queue_benchmark [messages] [max threads] [--producer-cpus=N] [--consumer-cpus=N]
+//                   [--fifo=PRIO] [--mlock]
+#include "bounded_queue.h"
+#include "ipc/runtime_config.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+constexpr std::size_t QUEUE_CAPACITY = 1024;
+constexpr uint64_t DEFAULT_MESSAGES = 2000000;
+constexpr unsigned DEFAULT_MAX_THREADS = 16;
+
+// Bounded ring with one lock, notify_one on each transition
+class MutexQueue {
+public:
+    MutexQueue() : head_(0), tail_(0) {}
+
+    void push(uint64_t value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this] { return head_ - tail_ < QUEUE_CAPACITY; });
+        slots_[head_++ % QUEUE_CAPACITY] = value;
+        lock.unlock();
+        not_empty_.notify_one();
+    }
+
+    void pop(uint64_t& out) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return head_ != tail_; });
+        out = slots_[tail_++ % QUEUE_CAPACITY];
+        lock.unlock();
+        not_full_.notify_one();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    uint64_t head_;
+    uint64_t tail_;
+    uint64_t slots_[QUEUE_CAPACITY];
+};
+
+typedef BoundedQueue<uint64_t, QUEUE_CAPACITY> LockFreeQueue;
+
+// Producer thread p runs on the p-th CPU of its role's set, consumers likewise
+static ipc::RuntimeConfig producer_runtime("producer");
+static ipc::RuntimeConfig consumer_runtime("consumer");
+
+// Returns messages per second, or 0 if the consumers saw the wrong values
+template <typename Queue>
+static double run(Queue& queue, unsigned pairs, uint64_t messages) {
+    std::atomic<uint64_t> sum(0);
+    uint64_t per_producer = messages / std::max(pairs, 1u);
+    uint64_t total = per_producer * std::max(pairs, 1u);
+    auto start = std::chrono::steady_clock::now();
+
+    if (pairs == 0) {
+        uint64_t value, local = 0;
+        for (uint64_t i = 0; i < total; ++i) {
+            queue.push(i);
+            queue.pop(value);
+            local += value;
+        }
+        sum = local;
+    } else {
+        std::vector<std::thread> threads;
+        for (unsigned p = 0; p < pairs; ++p) {
+            threads.push_back(std::thread([&queue, p, per_producer]() {
+                producer_runtime.apply_thread(p);
+                for (uint64_t i = 0; i < per_producer; ++i) {
+                    queue.push(p * per_producer + i);
+                }
+            }));
+        }
+        for (unsigned c = 0; c < pairs; ++c) {
+            // Consumers split the total evenly; producers' values interleave freely
+            threads.push_back(std::thread([&queue, &sum, c, per_producer]() {
+                consumer_runtime.apply_thread(c);
+                uint64_t value, local = 0;
+                for (uint64_t i = 0; i < per_producer; ++i) {
+                    queue.pop(value);
+                    local += value;
+                }
+                sum.fetch_add(local);
+            }));
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    bool ok = sum.load() == total * (total - 1) / 2;
+    return ok ? total / seconds : 0.0;
+}
+
+int main(int argc, char* argv[]) {
+    if (!producer_runtime.parse_args(argc, argv) || !consumer_runtime.parse_args(argc, argv)) {
+        return 1;
+    }
+    argc = ipc::RuntimeConfig::strip_args(argc, argv);
+    // The main thread runs the single-thread row, so it takes the producer's placement
+    if (!producer_runtime.apply()) {
+        return 1;
+    }
+    uint64_t messages = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : DEFAULT_MESSAGES;
+    unsigned max_threads = (argc > 2) ? static_cast<unsigned>(std::atoi(argv[2])) : DEFAULT_MAX_THREADS;
+    if (messages == 0 || max_threads == 0) {
+        std::cerr << "Usage: " << argv[0] << " [messages] [max threads]\n";
+        return 1;
+    }
+
+    std::cout << "Machine: " << ipc::describe_machine() << "\n"
+              << "Placement: " << producer_runtime.describe() << "; " << consumer_runtime.describe() << "\n"
+              << "Messages: " << messages << ", capacity: " << QUEUE_CAPACITY
+              << ", hardware threads: " << std::thread::hardware_concurrency() << "\n\n";
+    std::cout << std::setw(8) << "threads" << std::setw(18) << "mutex+cv msg/s"
+              << std::setw(18) << "bounded msg/s" << std::setw(10) << "speedup" << std::endl;
+
+    // Heap-allocated: both queues embed their slots
+    std::unique_ptr<MutexQueue> mutex_queue;
+    std::unique_ptr<LockFreeQueue> bounded_queue;
+    bool ok = true;
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        unsigned pairs = threads / 2;
+        mutex_queue.reset(new MutexQueue);
+        bounded_queue.reset(new LockFreeQueue);
+        double locked = run(*mutex_queue, pairs, messages);
+        double lock_free = run(*bounded_queue, pairs, messages);
+        ok = ok && locked > 0 && lock_free > 0;
+
+        std::cout << std::setw(8) << threads << std::fixed << std::setprecision(0)
+                  << std::setw(18) << locked << std::setw(18) << lock_free
+                  << std::setw(9) << std::setprecision(2) << (locked > 0 ? lock_free / locked : 0.0) << "x"
+                  << (ok ? "" : "  (wrong sum)") << std::endl;
+    }
+    return ok ? 0 : 1;
+}
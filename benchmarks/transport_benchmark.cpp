@@ -0,0 +1,380 @@
+// transport_benchmark.cpp
+//
+// Pits the inter-process transports in this repository against each other on
+// one harness: the producer runs in the parent, a single consumer in a forked
+// child, both sharing one MAP_SHARED segment. Every message carries its send
+// timestamp so the consumer can measure one-way latency.
+//
+//   transport_benchmark [messages] [transport ...] [--producer-cpus=N] [--consumer-cpus=N]
+//                       [--fifo=PRIO] [--mlock]
+//
+// Transports: message_queue, boost_channel, flip_flop, channel_spin, channel_futex
+#include "channel.h"     // mutex-between-multiple-processes-using-boost
+#include "common.h"      // single-producer-multiple-consumer
+#include "ipc/channel.h"
+#include "ipc/runtime_config.h"
+#include "ipc/shared_segment.h"
+#include "ipc/sync.h"
+#include <boost/interprocess/ipc/message_queue.hpp>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <sched.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+constexpr std::size_t RING_CAPACITY = 1024;
+constexpr uint32_t CHANNEL_NOTIFY_BATCH = 32;
+constexpr uint64_t DEFAULT_MESSAGES = 200000;
+constexpr const char* MQ_NAME = "ipc_bench_mq";
+
+struct BenchMessage {
+    uint64_t sequence;
+    uint64_t send_ns;
+    char payload[48];
+};
+
+static uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ---------------------------------------------------------------------------
+// Transports. Each one provides a shared Segment, init() run once before fork,
+// and Producer/Consumer handles constructed inside their own process.
+// ---------------------------------------------------------------------------
+
+struct MessageQueueTransport {
+    static const char* name() { return "message_queue"; }
+
+    struct Segment {};
+
+    static void init(Segment*) {
+        boost::interprocess::message_queue::remove(MQ_NAME);
+        boost::interprocess::message_queue mq(boost::interprocess::create_only, MQ_NAME,
+                                              RING_CAPACITY, sizeof(BenchMessage));
+    }
+
+    static void destroy(Segment*) {
+        boost::interprocess::message_queue::remove(MQ_NAME);
+    }
+
+    struct Producer {
+        boost::interprocess::message_queue mq;
+        explicit Producer(Segment*) : mq(boost::interprocess::open_only, MQ_NAME) {}
+        void send(const BenchMessage& message) { mq.send(&message, sizeof(message), 0); }
+        void finish() {}
+    };
+
+    struct Consumer {
+        boost::interprocess::message_queue mq;
+        explicit Consumer(Segment*) : mq(boost::interprocess::open_only, MQ_NAME) {}
+        void receive(BenchMessage& message) {
+            boost::interprocess::message_queue::size_type received;
+            unsigned int priority;
+            mq.receive(&message, sizeof(message), received, priority);
+        }
+    };
+};
+
+struct BoostChannelTransport {
+    static const char* name() { return "boost_channel"; }
+
+    typedef BoostChannel<BenchMessage, RING_CAPACITY> Segment;
+
+    static void init(Segment* channel) { channel->init(CHANNEL_NOTIFY_BATCH); }
+    static void destroy(Segment*) {}
+
+    struct Producer {
+        Segment* channel;
+        explicit Producer(Segment* segment) : channel(segment) {}
+        void send(const BenchMessage& message) { channel->send(message); }
+        void finish() { channel->flush(); }
+    };
+
+    struct Consumer {
+        Segment* channel;
+        BenchMessage batch[RING_CAPACITY];
+        std::size_t next = 0;
+        std::size_t available = 0;
+        explicit Consumer(Segment* segment) : channel(segment) {}
+        void receive(BenchMessage& message) {
+            if (next == available) {
+                available = channel->receive(batch, RING_CAPACITY);
+                next = 0;
+            }
+            message = batch[next++];
+        }
+    };
+};
+
+// Same SharedMemory struct and locking protocol as producer.cpp/consumer.cpp,
+// without the logging and with the producer's 5 ms poll replaced by a yield.
+// The side arrays carry the benchmark header for each flip-flop slot.
+struct FlipFlopTransport {
+    static const char* name() { return "flip_flop"; }
+
+    struct Segment {
+        SharedMemory shm;
+        BenchMessage side[BUFFER_SIZE];
+    };
+
+    static void init(Segment* segment) {
+        SharedMemory* shm = &segment->shm;
+        ipc::init_shared_mutex(&shm->mutex);
+        ipc::init_shared_cond(&shm->cond);
+
+        shm->current_index = 0;
+        shm->reader_count = 0;
+        shm->version = 0;
+        shm->active_consumers = 1;
+    }
+
+    static void destroy(Segment* segment) {
+        pthread_mutex_destroy(&segment->shm.mutex);
+        pthread_cond_destroy(&segment->shm.cond);
+    }
+
+    struct Producer {
+        Segment* segment;
+        explicit Producer(Segment* s) : segment(s) {}
+
+        void send(const BenchMessage& message) {
+            SharedMemory* shm = &segment->shm;
+            pthread_mutex_lock(&shm->mutex);
+            if (shm->reader_count >= shm->active_consumers) {
+                shm->current_index = 1 - shm->current_index;
+                shm->reader_count = 0;
+            }
+            int index = shm->current_index;
+            flipflop::Update* update = shm->slot[index].get();
+            update->init(STRING_SIZE);
+            update->version = shm->version + 1;
+            snprintf(update->text(), STRING_SIZE, "%010llu",
+                     static_cast<unsigned long long>(message.sequence % 10000000000ULL));
+            segment->side[index] = message;
+            ++shm->version;
+            pthread_cond_broadcast(&shm->cond);
+            pthread_mutex_unlock(&shm->mutex);
+
+            while (true) {
+                pthread_mutex_lock(&shm->mutex);
+                bool all_read = shm->reader_count >= shm->active_consumers;
+                pthread_mutex_unlock(&shm->mutex);
+                if (all_read) {
+                    break;
+                }
+                sched_yield();
+            }
+        }
+
+        void finish() {}
+    };
+
+    struct Consumer {
+        Segment* segment;
+        int last_version = 0;
+        explicit Consumer(Segment* s) : segment(s) {}
+
+        void receive(BenchMessage& message) {
+            SharedMemory* shm = &segment->shm;
+            pthread_mutex_lock(&shm->mutex);
+            while (shm->version == last_version) {
+                pthread_cond_wait(&shm->cond, &shm->mutex);
+            }
+            message = segment->side[shm->current_index];
+            last_version = shm->version;
+            ++shm->reader_count;
+            pthread_mutex_unlock(&shm->mutex);
+        }
+    };
+};
+
+// ipc::Channel with either wait policy: SpinWait never enters the kernel,
+// FutexWait parks a blocked side on a process-shared futex.
+template <typename WaitPolicy>
+struct ChannelTransport {
+    static const char* name();
+
+    typedef ipc::Channel<BenchMessage, RING_CAPACITY, WaitPolicy> Segment;
+    static_assert(ipc::ChannelLayout<Segment>::value, "");
+
+    static void init(Segment* channel) { channel->init(); }
+    static void destroy(Segment*) {}
+
+    struct Producer {
+        Segment* channel;
+        explicit Producer(Segment* segment) : channel(segment) {}
+        void send(const BenchMessage& message) { channel->push(message); }
+        void finish() {}
+    };
+
+    struct Consumer {
+        Segment* channel;
+        explicit Consumer(Segment* segment) : channel(segment) {}
+        void receive(BenchMessage& message) { channel->pop(message); }
+    };
+};
+
+template <> const char* ChannelTransport<ipc::SpinWait>::name() { return "channel_spin"; }
+template <> const char* ChannelTransport<ipc::FutexWait>::name() { return "channel_futex"; }
+
+// ---------------------------------------------------------------------------
+// Harness
+// ---------------------------------------------------------------------------
+
+struct Result {
+    std::atomic<uint32_t> consumer_ready;
+    uint64_t start_ns;     // Written by the producer before the first send
+    uint64_t end_ns;       // Written by the consumer after the last receive
+    uint64_t out_of_order; // Messages whose sequence was not the expected one
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+};
+
+template <typename Transport>
+struct HarnessSegment {
+    Result result;
+    typename Transport::Segment transport;
+};
+
+// Placement of the two sides; applied after fork() so neither inherits the other's
+static ipc::RuntimeConfig producer_runtime("producer");
+static ipc::RuntimeConfig consumer_runtime("consumer");
+
+template <typename Transport>
+static bool run_benchmark(uint64_t messages) {
+    typedef HarnessSegment<Transport> Segment;
+
+    // Boost transports are not standard layout, so the mapping is cast directly
+    ipc::SharedSegment shared;
+    if (!shared.anonymous(sizeof(Segment))) {
+        return false;
+    }
+    auto* segment = reinterpret_cast<Segment*>(shared.data());
+    Transport::init(&segment->transport);
+
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork");
+        return false;
+    }
+
+    if (pid == 0) {
+        if (!consumer_runtime.apply()) {
+            _exit(1);
+        }
+        typename Transport::Consumer consumer(&segment->transport);
+        std::vector<uint64_t> latencies(messages);
+        uint64_t out_of_order = 0;
+        BenchMessage message;
+
+        segment->result.consumer_ready.store(1, std::memory_order_release);
+        for (uint64_t i = 0; i < messages; ++i) {
+            consumer.receive(message);
+            latencies[i] = now_ns() - message.send_ns;
+            if (message.sequence != i) {
+                ++out_of_order;
+            }
+        }
+        segment->result.end_ns = now_ns();
+
+        std::sort(latencies.begin(), latencies.end());
+        segment->result.out_of_order = out_of_order;
+        segment->result.p50_ns = latencies[messages / 2];
+        segment->result.p99_ns = latencies[messages * 99 / 100];
+        segment->result.max_ns = latencies[messages - 1];
+        _exit(0);
+    }
+
+    if (!producer_runtime.apply()) {
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+        return false;
+    }
+    while (segment->result.consumer_ready.load(std::memory_order_acquire) == 0) {
+        if (waitpid(pid, nullptr, WNOHANG) == pid) {
+            std::cerr << Transport::name() << ": consumer exited before starting\n";
+            return false;
+        }
+        sched_yield();
+    }
+
+    {
+        typename Transport::Producer producer(&segment->transport);
+        BenchMessage message;
+        std::memset(&message, 0, sizeof(message));
+        segment->result.start_ns = now_ns();
+        for (uint64_t i = 0; i < messages; ++i) {
+            message.sequence = i;
+            message.send_ns = now_ns();
+            producer.send(message);
+        }
+        producer.finish();
+    }
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+
+    const Result& result = segment->result;
+    double seconds = (result.end_ns - result.start_ns) / 1e9;
+    std::cout << std::left << std::setw(16) << Transport::name() << std::right
+              << std::setw(14) << static_cast<uint64_t>(messages / seconds)
+              << std::setw(12) << result.p50_ns
+              << std::setw(12) << result.p99_ns
+              << std::setw(14) << result.max_ns
+              << std::setw(10) << result.out_of_order
+              << (ok ? "" : "  (consumer failed)") << std::endl;
+
+    ok = ok && result.out_of_order == 0;
+    Transport::destroy(&segment->transport);
+    return ok;
+}
+
+static bool selected(const std::vector<std::string>& names, const char* name) {
+    return names.empty() || std::find(names.begin(), names.end(), name) != names.end();
+}
+
+int main(int argc, char* argv[]) {
+    if (!producer_runtime.parse_args(argc, argv) || !consumer_runtime.parse_args(argc, argv)) {
+        return 1;
+    }
+    argc = ipc::RuntimeConfig::strip_args(argc, argv);
+    uint64_t messages = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : DEFAULT_MESSAGES;
+    if (messages == 0) {
+        std::cerr << "Usage: " << argv[0] << " [messages] [message_queue|boost_channel|flip_flop|channel_spin|channel_futex ...]"
+                  << " [--producer-cpus=LIST] [--consumer-cpus=LIST] [--fifo=PRIO] [--mlock]\n";
+        return 1;
+    }
+    std::vector<std::string> names(argv + std::min(argc, 2), argv + argc);
+
+    std::cout << "Machine: " << ipc::describe_machine() << "\n"
+              << "Placement: " << producer_runtime.describe() << "; " << consumer_runtime.describe() << "\n"
+              << "Messages: " << messages << ", payload: " << sizeof(BenchMessage)
+              << " bytes, ring capacity: " << RING_CAPACITY << "\n\n";
+    std::cout << std::left << std::setw(16) << "transport" << std::right
+              << std::setw(14) << "msgs/s"
+              << std::setw(12) << "p50 ns"
+              << std::setw(12) << "p99 ns"
+              << std::setw(14) << "max ns"
+              << std::setw(10) << "errors" << std::endl;
+
+    bool ok = true;
+    if (selected(names, MessageQueueTransport::name())) ok &= run_benchmark<MessageQueueTransport>(messages);
+    if (selected(names, BoostChannelTransport::name())) ok &= run_benchmark<BoostChannelTransport>(messages);
+    if (selected(names, FlipFlopTransport::name()))     ok &= run_benchmark<FlipFlopTransport>(messages);
+    if (selected(names, ChannelTransport<ipc::SpinWait>::name()))  ok &= run_benchmark<ChannelTransport<ipc::SpinWait>>(messages);
+    if (selected(names, ChannelTransport<ipc::FutexWait>::name())) ok &= run_benchmark<ChannelTransport<ipc::FutexWait>>(messages);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+// async_socket.h
+#ifndef ASYNC_SOCKET_H
+#define ASYNC_SOCKET_H
+
+#include "coro.h"
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstddef>
+
+namespace coro {
+
+/**
+ * @brief Non-blocking socket owned by one coroutine, with awaitable
+ *        read(), write() and accept().
+ *
+ * @details Each call returns an IoAwaitable: `co_await socket.read(buf, len)`
+ *          yields what read() would return, without ever blocking the thread.
+ *          A read and a write may be pending at the same time, from two
+ *          coroutines; two reads may not.
+ */
+class AsyncSocket {
+public:
+    /// Takes ownership of `fd`, makes it non-blocking and registers it with `scheduler`.
+    AsyncSocket(Scheduler& scheduler, int fd) : scheduler_(scheduler), registered_(false) {
+        io_.fd = fd;
+        int flags = fcntl(fd, F_GETFL, 0);
+        if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+            perror("fcntl");
+            return;
+        }
+        registered_ = scheduler_.add(&io_);
+    }
+
+    ~AsyncSocket() {
+        if (registered_) {
+            scheduler_.remove(&io_);
+        }
+        close(io_.fd);
+    }
+
+    AsyncSocket(const AsyncSocket&) = delete;
+    AsyncSocket& operator=(const AsyncSocket&) = delete;
+
+    /// False if the descriptor could not be registered; the socket is unusable then.
+    bool valid() const { return registered_; }
+
+    int fd() const { return io_.fd; }
+
+    auto read(void* buf, std::size_t len) {
+        int fd = io_.fd;
+        return IoAwaitable(&io_, false, [fd, buf, len]() { return ::read(fd, buf, len); });
+    }
+
+    auto write(const void* buf, std::size_t len) {
+        int fd = io_.fd;
+        return IoAwaitable(&io_, true, [fd, buf, len]() { return ::send(fd, buf, len, MSG_NOSIGNAL); });
+    }
+
+    /// For a listening socket: the accepted descriptor, already non-blocking, or -1.
+    auto accept() {
+        int fd = io_.fd;
+        return IoAwaitable(&io_, false, [fd]() { return accept4(fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC); });
+    }
+
+private:
+    Scheduler& scheduler_;
+    IoWaiters io_;
+    bool registered_;
+};
+
+} // namespace coro
+
+#endif
@@ -0,0 +1,242 @@
+// coro.h
+#ifndef CORO_H
+#define CORO_H
+
+#include "trace.h"
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <chrono>
+#include <coroutine>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace coro {
+
+/**
+ * @brief Detached coroutine: starts running when called and frees its frame
+ *        when it returns. Every logical consumer or connection is one Task;
+ *        while it waits it costs only its frame, not a thread stack.
+ */
+struct Task {
+    struct promise_type {
+        Task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+struct IoOperation;
+
+/**
+ * @brief A descriptor registered with a Scheduler and the operations waiting
+ *        for it: at most one reader and one writer.
+ */
+struct IoWaiters {
+    int fd = -1;
+    IoOperation* reader = nullptr;
+    IoOperation* writer = nullptr;
+};
+
+/**
+ * @brief A pending syscall on an IoWaiters and the coroutine waiting for it.
+ *
+ * @details The scheduler calls attempt() when the descriptor becomes ready and
+ *          resumes the coroutine only once it succeeds, so a coroutine never
+ *          wakes up to an EAGAIN.
+ */
+struct IoOperation {
+    std::coroutine_handle<> handle;
+
+    /// Runs the syscall; false if it would still block.
+    virtual bool attempt() = 0;
+
+protected:
+    ~IoOperation() = default;
+};
+
+/**
+ * @brief Awaits `syscall()` on a non-blocking descriptor; the result of
+ *        co_await is its return value, with errno set as the syscall left it.
+ *
+ * @details The syscall is tried first and the coroutine suspends only after
+ *          EAGAIN. Since the scheduler runs on the same thread, no readiness
+ *          edge can be lost between that EAGAIN and the suspension.
+ *
+ *          Completed attempts are traced as `coro.read`/`coro.write`. A span
+ *          must not stay open across a suspension: spans of other coroutines
+ *          on the thread would overlap it without nesting.
+ */
+template <typename Syscall>
+class IoAwaitable : public IoOperation {
+public:
+    IoAwaitable(IoWaiters* io, bool write, Syscall syscall)
+        : io_(io), write_(write), syscall_(syscall), result_(-1), error_(0) {}
+
+    bool await_ready() { return attempt(); }
+
+    void await_suspend(std::coroutine_handle<> h) noexcept {
+        handle = h;
+        (write_ ? io_->writer : io_->reader) = this;
+    }
+
+    long await_resume() const noexcept {
+        errno = error_;
+        return result_;
+    }
+
+    bool attempt() override {
+        bool completed;
+        if (write_) {
+            TRACE_SPAN_IF("coro.write", completed);
+            completed = try_syscall();
+        } else {
+            TRACE_SPAN_IF("coro.read", completed);
+            completed = try_syscall();
+        }
+        return completed;
+    }
+
+private:
+    bool try_syscall() {
+        result_ = static_cast<long>(syscall_());
+        if (result_ == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return false;
+        }
+        error_ = (result_ == -1) ? errno : 0;
+        return true;
+    }
+
+    IoWaiters* io_;
+    bool write_;
+    Syscall syscall_;
+    long result_;
+    int error_;
+};
+
+/**
+ * @brief Single-threaded event loop that resumes coroutines when their
+ *        descriptor is ready or their timer expires.
+ *
+ * @details Descriptors are registered once, edge-triggered, for both
+ *          directions, and waited on through IoAwaitable. Coroutines resume
+ *          inline from run(), so one scheduler never needs locks.
+ *          Use one Scheduler per thread to spread work over a few threads.
+ */
+class Scheduler {
+public:
+    Scheduler() : epoll_fd_(-1), stopped_(false), next_timer_id_(0) {}
+    ~Scheduler() {
+        if (epoll_fd_ != -1) {
+            close(epoll_fd_);
+        }
+    }
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    bool init() {
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd_ == -1) {
+            perror("epoll_create1");
+            return false;
+        }
+        return true;
+    }
+
+    /// Starts watching `io->fd`; `io` must stay valid until remove().
+    bool add(IoWaiters* io) {
+        epoll_event ev = {};
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.ptr = io;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, io->fd, &ev) == -1) {
+            perror("epoll_ctl");
+            return false;
+        }
+        return true;
+    }
+
+    void remove(IoWaiters* io) { epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, io->fd, nullptr); }
+
+    /// Suspends the calling coroutine for `ms` milliseconds.
+    auto sleep(int ms) {
+        struct Awaitable {
+            Scheduler* scheduler;
+            int ms;
+            bool await_ready() const noexcept { return ms <= 0; }
+            void await_suspend(std::coroutine_handle<> h) {
+                scheduler->timers_.push(Timer{Clock::now() + std::chrono::milliseconds(ms),
+                                              scheduler->next_timer_id_++, h});
+            }
+            void await_resume() const noexcept {}
+        };
+        return Awaitable{this, ms};
+    }
+
+    /// Runs until stop(): resumes coroutines whose descriptor or timer is ready.
+    void run() {
+        epoll_event events[64];
+        while (!stopped_) {
+            int timeout = -1;
+            if (!timers_.empty()) {
+                auto wait = std::chrono::ceil<std::chrono::milliseconds>(timers_.top().deadline - Clock::now());
+                timeout = wait.count() > 0 ? static_cast<int>(wait.count()) : 0;
+            }
+            int nfds = epoll_wait(epoll_fd_, events, 64, timeout);
+            // Complete every operation before resuming any: a resumed coroutine
+            // may finish and destroy the IoWaiters it owns
+            ready_.clear();
+            for (int i = 0; i < nfds; ++i) {
+                IoWaiters* io = static_cast<IoWaiters*>(events[i].data.ptr);
+                if ((events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) && io->reader &&
+                    io->reader->attempt()) {
+                    ready_.push_back(std::exchange(io->reader, nullptr)->handle);
+                }
+                if ((events[i].events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) && io->writer &&
+                    io->writer->attempt()) {
+                    ready_.push_back(std::exchange(io->writer, nullptr)->handle);
+                }
+            }
+            for (std::coroutine_handle<> h : ready_) {
+                h.resume();
+            }
+            auto now = Clock::now();
+            while (!timers_.empty() && timers_.top().deadline <= now) {
+                std::coroutine_handle<> h = timers_.top().handle;
+                timers_.pop();
+                h.resume();
+            }
+        }
+    }
+
+    void stop() { stopped_ = true; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Timer {
+        Clock::time_point deadline;
+        uint64_t id; // Keeps timers with the same deadline in FIFO order
+        std::coroutine_handle<> handle;
+
+        bool operator>(const Timer& other) const {
+            return deadline != other.deadline ? deadline > other.deadline : id > other.id;
+        }
+    };
+
+    int epoll_fd_;
+    bool stopped_;
+    uint64_t next_timer_id_;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers_;
+    std::vector<std::coroutine_handle<>> ready_;
+};
+
+} // namespace coro
+
+#endif
@@ -0,0 +1,72 @@
+// coro_consumer.cpp
+//
+// Many logical consumers of the flip-flop segment on one thread: each is a
+// coroutine looping on `co_await channel.recv(cursor)`, optionally followed
+// by simulated work as a timer wait, the way consumer.cpp sleeps after each
+// read. Start it next to producer and one consumer (MAX_CONSUMERS readers).
+//
+//   coro_consumer [logical consumers] [work ms]   (default 1000, 100)
+#include "flipflop_channel.h"
+#include "async_logger.h"
+#include "ipc/runtime_config.h"
+#include <unistd.h>
+#include <cstdint>
+#include <cstdlib>
+
+constexpr int DEFAULT_LOGICAL_CONSUMERS = 1000;
+constexpr int DEFAULT_WORK_MS = 100;
+constexpr int STATS_INTERVAL_MS = 1000;
+
+static coro::Task logical_consumer(coro::Scheduler& scheduler, coro::FlipFlopChannel& channel, int id,
+                                   int work_ms, uint64_t& deliveries) {
+    const int pid = getpid();
+    int cursor = -1;
+    while (true) {
+        coro::FlipFlopMessage message = co_await channel.recv(cursor);
+        ++deliveries;
+        if (id == 0) {
+            LOG_INFO("[Coro consumer %d] Read: %s (ver: %d)", pid, message.text, message.version);
+        }
+        co_await scheduler.sleep(work_ms);
+    }
+}
+
+static coro::Task report(coro::Scheduler& scheduler, coro::FlipFlopChannel& channel, uint64_t& deliveries) {
+    const int pid = getpid();
+    while (true) {
+        co_await scheduler.sleep(STATS_INTERVAL_MS);
+        LOG_INFO("[Coro consumer %d] %llu deliveries/s, %zu consumers waiting for the next version", pid,
+                 static_cast<unsigned long long>(deliveries * 1000 / STATS_INTERVAL_MS), channel.waiting());
+        deliveries = 0;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    ipc::RuntimeConfig runtime("consumer");
+    if (!runtime.parse_args(argc, argv) || !runtime.apply()) {
+        return 1;
+    }
+    argc = ipc::RuntimeConfig::strip_args(argc, argv);
+    int consumers = (argc > 1) ? std::atoi(argv[1]) : DEFAULT_LOGICAL_CONSUMERS;
+    int work_ms = (argc > 2) ? std::atoi(argv[2]) : DEFAULT_WORK_MS;
+
+    coro::Scheduler scheduler;
+    if (!scheduler.init()) {
+        return 1;
+    }
+    coro::FlipFlopChannel channel(scheduler);
+    if (!channel.open()) {
+        return 1;
+    }
+    LOG_INFO("[Coro consumer %d] Attached with %d logical consumers, %d ms of work per read. Runtime: %s",
+             static_cast<int>(getpid()), consumers, work_ms, runtime.describe().c_str());
+
+    uint64_t deliveries = 0;
+    for (int id = 0; id < consumers; ++id) {
+        logical_consumer(scheduler, channel, id, work_ms, deliveries);
+    }
+    report(scheduler, channel, deliveries);
+
+    scheduler.run();
+    return 0;
+}
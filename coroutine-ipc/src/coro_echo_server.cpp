@@ -0,0 +1,145 @@
+// coro_echo_server.cpp
+//
+// The echo server of multi-threaded-tcp-server without a thread per client:
+// every connection is a coroutine that awaits socket.read() and
+// socket.write(). Each of the few worker threads runs its own scheduler and
+// its own SO_REUSEPORT listener, so the kernel spreads connections over the
+// threads and no state is shared between them. Works with its client:
+//
+//   coro_echo_server [port] [threads]   (default 9092, 1)
+//   client 127.0.0.1 9092
+#include "async_socket.h"
+#include "coro.h"
+#include "async_logger.h"
+#include "ipc/runtime_config.h"
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+constexpr int DEFAULT_PORT = 9092;
+constexpr int DEFAULT_THREADS = 1;
+constexpr int BUFFER_BYTES = 1024;
+
+static std::atomic<int> open_sessions(0);
+
+static int open_listener(int port) {
+    int listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd == -1) {
+        perror("socket");
+        return -1;
+    }
+    int opt = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1 ||
+        listen(listen_fd, SOMAXCONN) == -1) {
+        perror("bind/listen");
+        close(listen_fd);
+        return -1;
+    }
+    return listen_fd;
+}
+
+// Echoes everything the client sends until it disconnects
+static coro::Task session(coro::Scheduler& scheduler, int client_fd) {
+    coro::AsyncSocket socket(scheduler, client_fd);
+    if (!socket.valid()) {
+        co_return;
+    }
+    LOG_INFO("[Echo server] Client connected (fd: %d, %d open)", client_fd, ++open_sessions);
+
+    char buf[BUFFER_BYTES];
+    while (true) {
+        long n = co_await socket.read(buf, sizeof(buf));
+        if (n <= 0) {
+            if (n == -1) {
+                perror("read");
+            }
+            break;
+        }
+        LOG_DEBUG("[Echo server] Received %ld bytes from fd %d", n, client_fd);
+
+        // A full socket buffer suspends this session only, not the thread
+        long sent = 0;
+        while (sent < n) {
+            long written = co_await socket.write(buf + sent, static_cast<std::size_t>(n - sent));
+            if (written == -1) {
+                perror("write");
+                break;
+            }
+            sent += written;
+        }
+        if (sent < n) {
+            break;
+        }
+    }
+    LOG_INFO("[Echo server] Client disconnected (fd: %d, %d open)", client_fd, --open_sessions);
+}
+
+static coro::Task accept_loop(coro::Scheduler& scheduler, int listen_fd) {
+    coro::AsyncSocket listener(scheduler, listen_fd);
+    if (!listener.valid()) {
+        scheduler.stop();
+        co_return;
+    }
+    while (true) {
+        long client_fd = co_await listener.accept();
+        if (client_fd == -1) {
+            // Out of descriptors or an aborted handshake; keep serving the others
+            perror("accept4");
+            co_await scheduler.sleep(10);
+            continue;
+        }
+        session(scheduler, static_cast<int>(client_fd));
+    }
+}
+
+static void serve(const ipc::RuntimeConfig* runtime, unsigned index, int port) {
+    runtime->apply_thread(index);
+    coro::Scheduler scheduler;
+    if (!scheduler.init()) {
+        return;
+    }
+    int listen_fd = open_listener(port);
+    if (listen_fd == -1) {
+        return;
+    }
+    accept_loop(scheduler, listen_fd);
+    scheduler.run();
+}
+
+int main(int argc, char* argv[]) {
+    ipc::RuntimeConfig runtime("server");
+    if (!runtime.parse_args(argc, argv) || !runtime.apply()) {
+        return 1;
+    }
+    argc = ipc::RuntimeConfig::strip_args(argc, argv);
+    int port = (argc > 1) ? std::atoi(argv[1]) : DEFAULT_PORT;
+    int threads = (argc > 2) ? std::atoi(argv[2]) : DEFAULT_THREADS;
+    if (threads < 1) {
+        threads = 1;
+    }
+    LOG_INFO("[Echo server] Listening on port %d with %d scheduler thread(s). Runtime: %s", port, threads,
+             runtime.describe().c_str());
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threads; ++i) {
+        workers.push_back(std::thread(serve, &runtime, static_cast<unsigned>(i), port));
+    }
+    serve(&runtime, 0, port);
+    for (auto& t : workers) {
+        t.join();
+    }
+    return 0;
+}
@@ -0,0 +1,206 @@
+// flipflop_channel.h
+#ifndef FLIPFLOP_CHANNEL_H
+#define FLIPFLOP_CHANNEL_H
+
+#include "common.h"
+#include "coro.h"
+#include "async_logger.h"
+#include "trace.h"
+#include "ipc/metrics.h"
+#include "ipc/notifier.h"
+#include "ipc/segment_header.h"
+#include "ipc/shared_segment.h"
+#include "ipc/sync.h"
+#include <unistd.h>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace coro {
+
+struct FlipFlopMessage {
+    int version;
+    char text[STRING_SIZE];
+};
+
+/**
+ * @brief The flip-flop segment of single-producer-multiple-consumer as an
+ *        awaitable channel: `co_await channel.recv(cursor)`.
+ *
+ * @details The process takes a single consumer slot, like gateway.cpp: it
+ *          registers an eventfd with the producer and reads each version from
+ *          shared memory once. Every coroutine waiting in recv() is then
+ *          resumed with that copy, so thousands of logical consumers cost the
+ *          producer one reader and one wake-up, and cost this process one
+ *          coroutine frame each instead of a thread.
+ *
+ *          Like the other consumers, a logical consumer that falls behind
+ *          receives the newest version, not every one it missed.
+ */
+class FlipFlopChannel {
+public:
+    explicit FlipFlopChannel(Scheduler& scheduler)
+        : scheduler_(scheduler), shm_(nullptr), metrics_(nullptr), granted_pid_(0), pid_(getpid()),
+          registered_(false) {
+        latest_.version = -1;
+        latest_.text[0] = '\0';
+    }
+
+    ~FlipFlopChannel() {
+        if (registered_) {
+            scheduler_.remove(&event_io_);
+        }
+    }
+
+    FlipFlopChannel(const FlipFlopChannel&) = delete;
+    FlipFlopChannel& operator=(const FlipFlopChannel&) = delete;
+
+    /// Attaches to the segment and starts delivering; recv() only completes while the scheduler runs.
+    bool open() {
+        if (!ipc::attach_ready_segment(segment_, SHM_NAME, SHM_SIZE, SHM_MAGIC, SHM_LAYOUT_VERSION,
+                                       SHM_ATTACH_TIMEOUT_MS)) {
+            std::cerr << "[Channel] Failed to open shared memory" << std::endl;
+            return false;
+        }
+        shm_ = segment_.as<SharedMemory>();
+        metrics_ = ipc::metrics_page(segment_)->claim(ipc::METRICS_CONSUMER);
+        if (metrics_ == nullptr) {
+            std::cerr << "[Channel] No free metrics slot" << std::endl;
+            return false;
+        }
+        granted_pid_ = shm_->producer_pid;
+        if (!listener_.attach(shm_->notify, MAX_CONSUMERS, granted_pid_)) {
+            return false;
+        }
+        event_io_.fd = listener_.fd();
+        registered_ = scheduler_.add(&event_io_);
+        if (!registered_) {
+            return false;
+        }
+        pump();
+        watch_producer();
+        return true;
+    }
+
+    /**
+     * Completes with the newest message once its version differs from
+     * `cursor`, and advances `cursor` to it. Start with a cursor of -1.
+     */
+    auto recv(int& cursor) {
+        struct Awaitable {
+            FlipFlopChannel* channel;
+            int* cursor;
+            bool await_ready() const noexcept {
+                return channel->latest_.version != -1 && channel->latest_.version != *cursor;
+            }
+            void await_suspend(std::coroutine_handle<> h) { channel->waiters_.push_back(h); }
+            FlipFlopMessage await_resume() const noexcept {
+                *cursor = channel->latest_.version;
+                return channel->latest_;
+            }
+        };
+        return Awaitable{this, &cursor};
+    }
+
+    /// Coroutines currently suspended in recv().
+    std::size_t waiting() const { return waiters_.size(); }
+
+private:
+    // Re-checks the producer this often, as the gateway does when idle
+    static constexpr int WATCH_INTERVAL_MS = 100;
+
+    // Copies the current version into latest_ if this process has not read it yet
+    bool read_next() {
+        TRACE_SPAN("channel.read");
+        ipc::lock_shared_mutex(&shm_->mutex);
+        bool fresh = shm_->version != latest_.version;
+        if (fresh) {
+            // The first read has nothing to lag behind
+            int behind = (latest_.version == -1) ? 0 : shm_->version - latest_.version;
+            ipc::metric_set(metrics_->lag, behind);
+            if (behind > 1) {
+                ipc::metric_add(metrics_->overruns, behind - 1);
+            }
+            ipc::metric_add(metrics_->messages);
+            int index = shm_->current_index;
+            const flipflop::Update* update = verified_update(shm_, index);
+            if (update != nullptr) {
+                std::memcpy(latest_.text, update->text(), STRING_SIZE);
+            } else {
+                LOG_WARN("[Channel %d] Invalid update in buffer %d (ver: %d)", pid_, index, shm_->version);
+                latest_.text[0] = '\0';
+            }
+            latest_.version = shm_->version;
+            ++shm_->reader_count;
+        }
+        pthread_mutex_unlock(&shm_->mutex);
+        return fresh;
+    }
+
+    bool has_work() {
+        ipc::lock_shared_mutex(&shm_->mutex);
+        bool fresh = shm_->version != latest_.version;
+        pthread_mutex_unlock(&shm_->mutex);
+        return fresh;
+    }
+
+    // Reads each new version once and resumes every coroutine waiting for it
+    Task pump() {
+        std::vector<std::coroutine_handle<>> ready;
+        uint64_t value;
+        int fd = listener_.fd();
+        while (true) {
+            while (read_next()) {
+                ready.swap(waiters_);
+                for (std::coroutine_handle<> h : ready) {
+                    h.resume();
+                }
+                ready.clear();
+            }
+            if (listener_.go_idle([this]() { return has_work(); })) {
+                ipc::metric_add(metrics_->waits);
+                co_await IoAwaitable(&event_io_, false, [fd, &value]() { return ::read(fd, &value, sizeof(value)); });
+            }
+            listener_.drain();
+        }
+    }
+
+    // A restarted producer may not be allowed to copy our eventfd until we
+    // grant it access, and may have missed waking us; catch up periodically
+    Task watch_producer() {
+        while (true) {
+            co_await scheduler_.sleep(WATCH_INTERVAL_MS);
+            ipc::lock_shared_mutex(&shm_->mutex);
+            int producer_pid = shm_->producer_pid;
+            pthread_mutex_unlock(&shm_->mutex);
+            if (producer_pid != granted_pid_) {
+                granted_pid_ = producer_pid;
+                listener_.allow(granted_pid_);
+                LOG_INFO("[Channel %d] Producer %d took over the segment.", pid_, granted_pid_);
+            }
+            if (has_work()) {
+                uint64_t one = 1;
+                if (::write(listener_.fd(), &one, sizeof(one)) == -1 && errno != EAGAIN) {
+                    perror("eventfd write");
+                }
+            }
+        }
+    }
+
+    Scheduler& scheduler_;
+    ipc::SharedSegment segment_;
+    SharedMemory* shm_;
+    ipc::RoleMetrics* metrics_;
+    ipc::NotifyListener listener_;
+    IoWaiters event_io_;
+    int granted_pid_;
+    int pid_;
+    bool registered_;
+    FlipFlopMessage latest_;
+    std::vector<std::coroutine_handle<>> waiters_;
+};
+
+} // namespace coro
+
+#endif
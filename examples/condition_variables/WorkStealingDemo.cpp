@@ -0,0 +1,71 @@
+// WorkStealingDemo.cpp
+//
+// The same scenario as Demo.cpp - NTHREADS idle workers, and the main thread
+// handing them work - but on WorkStealingPool instead of one global
+// pthread_cond_t guarding a workToDo flag. Each job is a real queue entry, so
+// nothing is lost when workers are busy, and only one parked worker is woken
+// per job instead of broadcasting to all of them.
+//
+// The second part fans a job out into many small tasks from inside the pool:
+// tasks spawned by a worker go onto its own deque and idle workers steal them.
+#include "work_stealing_pool.h"
+#include "logger.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#define NTHREADS      5
+#define FANOUT_TASKS  100000
+
+// Splits [begin, end) in halves until it is small, summing the leaves
+static void sum_range(WorkStealingPool& pool, std::atomic<uint64_t>& total, uint64_t begin, uint64_t end) {
+    while (end - begin > FANOUT_TASKS / 64) {
+        uint64_t middle = begin + (end - begin) / 2;
+        pool.submit([&pool, &total, middle, end]() { sum_range(pool, total, middle, end); });
+        end = middle;
+    }
+    uint64_t sum = 0;
+    for (uint64_t i = begin; i < end; ++i) {
+        sum += i;
+    }
+    total.fetch_add(sum, std::memory_order_relaxed);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned threads = (argc > 1) ? static_cast<unsigned>(std::atoi(argv[1])) : NTHREADS;
+
+    log_message(GREEN, "Enter Testcase - main thread started");
+    WorkStealingPool pool(threads);
+
+    char message[128];
+    snprintf(message, sizeof(message), "Created pool with %u workers, all parked on a futex", pool.size());
+    log_message(BLUE, message);
+
+    for (int i = 0; i < 2; ++i) {
+        log_message(YELLOW, "Submit work...");
+        pool.submit([i]() {
+            char text[64];
+            snprintf(text, sizeof(text), "Worker awake, finish work item %d!", i);
+            log_message(GREEN, text);
+        });
+        pool.wait_idle();
+    }
+
+    std::atomic<uint64_t> total(0);
+    auto start = std::chrono::steady_clock::now();
+    pool.submit([&pool, &total]() { sum_range(pool, total, 0, FANOUT_TASKS * 1000ULL); });
+    pool.wait_idle();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    uint64_t n = FANOUT_TASKS * 1000ULL;
+    snprintf(message, sizeof(message), "Fan-out sum of [0, %llu) = %llu (%s) in %lld us",
+             static_cast<unsigned long long>(n), static_cast<unsigned long long>(total.load()),
+             total.load() == n * (n - 1) / 2 ? "correct" : "WRONG", static_cast<long long>(elapsed.count()));
+    log_message(GREEN, message);
+
+    log_message(GREEN, "Main completed");
+    return total.load() == n * (n - 1) / 2 ? 0 : 1;
+}
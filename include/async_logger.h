@@ -0,0 +1,751 @@
+#ifndef ASYNC_LOGGER_H
+#define ASYNC_LOGGER_H
+
+#include "binary_log_format.h"
+#include "ipc/runtime_config.h"
+#include "log_level.h"
+#include "tsc_clock.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include <pthread.h>
+
+/**
+ * @brief Asynchronous logger for hot paths.
+ *
+ * @details `ASYNC_LOG(fmt, args...)` does not format anything on the calling
+ *          thread. It appends a binary record to a per-thread lock-free SPSC
+ *          buffer:
+ *
+ *              [size:u32][format id:u32][tsc:u64][raw arguments...]
+ *
+ *          The format string is registered once per call site and referred to
+ *          by id afterwards. Strings are copied into the record at call time,
+ *          everything else is copied as raw bytes. A background thread drains
+ *          all thread buffers every millisecond, orders the records by TSC,
+ *          formats them with printf semantics and writes each batch with a
+ *          single fwrite. The date prefix is cached and only rebuilt when the
+ *          second changes.
+ *
+ *          Setting `ASYNC_LOG_BINARY=<path>` (or calling set_binary_output())
+ *          makes the backend skip formatting and append compact binary
+ *          entries (see binary_log_format.h) instead; tools/log_decoder turns
+ *          such a file back into the usual text lines.
+ *
+ *          `LOG_TRACE` ... `LOG_ERROR` are compiled out entirely below
+ *          `LOG_ACTIVE_LEVEL`, including the evaluation of their arguments.
+ *
+ * @note The hot path never blocks: if a thread's buffer is full the record is
+ *       dropped and counted, and the backend reports the number of drops.
+ *       Arguments must be arithmetic, enums, pointers or C strings; pass
+ *       `std::string` values as `.c_str()`.
+ */
+namespace async_log {
+
+constexpr std::size_t THREAD_BUFFER_SIZE = 1 << 20;   // Bytes per logging thread
+constexpr std::size_t MAX_FORMATS = 4096;             // Distinct call sites
+constexpr unsigned FLUSH_INTERVAL_US = 1000;          // Backend poll interval
+constexpr uint32_t PADDING_ID = 0xFFFFFFFFu;
+
+struct RecordHeader {
+    uint32_t size;      // Whole record including header, multiple of 16
+    uint32_t format_id;
+    uint64_t tsc;
+};
+
+static_assert(sizeof(RecordHeader) == 16, "Records are padded to 16 bytes");
+static_assert(THREAD_BUFFER_SIZE % 16 == 0, "Ring size must keep records 16-byte aligned");
+
+// ---------------------------------------------------------------------------
+// Argument encoding
+// ---------------------------------------------------------------------------
+
+template <std::size_t... I> struct indices {};
+template <std::size_t N, std::size_t... I> struct build_indices : build_indices<N - 1, N - 1, I...> {};
+template <std::size_t... I> struct build_indices<0, I...> { typedef indices<I...> type; };
+
+// Arithmetic values, enums and pointers are stored as raw bytes
+template <typename T>
+struct ArgCodec {
+    static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value,
+                  "ASYNC_LOG arguments must be arithmetic, enum, pointer or C string");
+    typedef T stored_type;
+
+    static std::size_t size(T) { return sizeof(T); }
+    static char* encode(char* p, T value) {
+        std::memcpy(p, &value, sizeof(T));
+        return p + sizeof(T);
+    }
+    static const char* decode(const char* p, T& value) {
+        std::memcpy(&value, p, sizeof(T));
+        return p + sizeof(T);
+    }
+    static T pass(T value) { return value; }
+};
+
+// C strings are copied into the record: [length:u32][bytes]
+struct StringCodec {
+    typedef std::string stored_type;
+
+    static std::size_t size(const char* value) {
+        return sizeof(uint32_t) + (value ? std::strlen(value) : 6);
+    }
+    static char* encode(char* p, const char* value) {
+        if (value == nullptr) {
+            value = "(null)";
+        }
+        uint32_t length = static_cast<uint32_t>(std::strlen(value));
+        std::memcpy(p, &length, sizeof(length));
+        std::memcpy(p + sizeof(length), value, length);
+        return p + sizeof(length) + length;
+    }
+    static const char* decode(const char* p, std::string& value) {
+        uint32_t length;
+        std::memcpy(&length, p, sizeof(length));
+        value.assign(p + sizeof(length), length);
+        return p + sizeof(length) + length;
+    }
+    static const char* pass(const std::string& value) { return value.c_str(); }
+};
+
+template <> struct ArgCodec<const char*> : StringCodec {};
+template <> struct ArgCodec<char*> : StringCodec {};
+
+inline void append_format(std::string& out, const char* fmt, ...) {
+    char stack[512];
+    va_list args;
+    va_start(args, fmt);
+    int length = vsnprintf(stack, sizeof(stack), fmt, args);
+    va_end(args);
+    if (length < 0) {
+        return;
+    }
+    if (static_cast<std::size_t>(length) < sizeof(stack)) {
+        out.append(stack, length);
+        return;
+    }
+    std::size_t offset = out.size();
+    out.resize(offset + length + 1);
+    va_start(args, fmt);
+    vsnprintf(&out[offset], length + 1, fmt, args);
+    va_end(args);
+    out.resize(offset + length);
+}
+
+typedef void (*DecodeFn)(const char* fmt, const char* args, std::string& out);
+
+// Instantiated per call-site argument list; runs on the backend thread only
+template <typename... Args>
+struct Decoder {
+    typedef std::tuple<typename ArgCodec<Args>::stored_type...> Stored;
+
+    /// One binlog::TypeTag character per argument
+    static const char* signature() {
+        static const char tags[] = {binlog::TypeTag<Args>::value..., '\0'};
+        return tags;
+    }
+
+    static void format(const char* fmt, const char* args, std::string& out) {
+        Stored values;
+        decode_all(args, values, typename build_indices<sizeof...(Args)>::type());
+        emit(fmt, values, out, typename build_indices<sizeof...(Args)>::type());
+    }
+
+private:
+    template <std::size_t... I>
+    static void decode_all(const char* p, Stored& values, indices<I...>) {
+        int expand[] = {0, (p = ArgCodec<Args>::decode(p, std::get<I>(values)), 0)...};
+        (void)expand;
+        (void)p;
+        (void)values;
+    }
+
+    template <std::size_t... I>
+    static void emit(const char* fmt, const Stored& values, std::string& out, indices<I...>) {
+        append_format(out, fmt, ArgCodec<Args>::pass(std::get<I>(values))...);
+        (void)values;
+    }
+};
+
+// Lets the compiler check the format string against the arguments
+inline void check_format(const char*, ...) __attribute__((format(printf, 1, 2)));
+inline void check_format(const char*, ...) {}
+
+// ---------------------------------------------------------------------------
+// Per-thread buffer and call-site registry
+// ---------------------------------------------------------------------------
+
+struct CallSite {
+    const char* fmt;
+    int level;
+    std::atomic<uint32_t> id; // 0 until registered
+
+    constexpr CallSite(const char* format, int log_level) : fmt(format), level(log_level), id(0) {}
+};
+
+struct FormatEntry {
+    const char* fmt;
+    const char* signature;
+    int level;
+    DecodeFn decode;
+};
+
+/// Byte ring written by one application thread and drained by the backend.
+struct ThreadBuffer {
+    alignas(64) std::atomic<uint64_t> head; // Bytes published by the owner thread
+    uint64_t cached_tail;                   // Owner's view of tail
+    std::atomic<uint64_t> dropped;          // Records dropped because the ring was full
+    alignas(64) std::atomic<uint64_t> tail; // Bytes consumed by the backend
+    uint64_t reported_drops;                // Backend's last reported drop count
+    std::atomic<bool> retired;              // Owner thread has exited
+    uint32_t binary_index;                  // Backend's thread index in the binary stream
+    uint32_t binary_stream;                 // Binary stream in which binary_index was defined, 0 = none
+    unsigned long thread_id;
+    std::unique_ptr<char[]> data;
+
+    // The cache-line alignment above needs an aligned allocation before C++17
+    static void* operator new(std::size_t size) {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, 64, size) != 0) {
+            throw std::bad_alloc();
+        }
+        return memory;
+    }
+    static void operator delete(void* memory) { std::free(memory); }
+
+    ThreadBuffer()
+        : head(0), cached_tail(0), dropped(0), tail(0), reported_drops(0), retired(false), binary_index(0), binary_stream(0),
+          thread_id(static_cast<unsigned long>(pthread_self())), data(new char[THREAD_BUFFER_SIZE]) {}
+
+    /**
+     * Reserves `size` contiguous bytes (size is a multiple of 16, so the gap
+     * left before the end of the ring always fits a padding header).
+     * @return nullptr when the ring is full
+     */
+    char* reserve(std::size_t size, uint64_t& advance) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        std::size_t offset = h % THREAD_BUFFER_SIZE;
+        std::size_t contiguous = THREAD_BUFFER_SIZE - offset;
+        std::size_t needed = size <= contiguous ? size : contiguous + size;
+
+        if (h + needed - cached_tail > THREAD_BUFFER_SIZE) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (h + needed - cached_tail > THREAD_BUFFER_SIZE) {
+                return nullptr;
+            }
+        }
+
+        advance = needed;
+        if (needed == size) {
+            return data.get() + offset;
+        }
+        // Not enough room before the end: pad to the end and wrap around
+        RecordHeader padding = {static_cast<uint32_t>(contiguous), PADDING_ID, 0};
+        std::memcpy(data.get() + offset, &padding, sizeof(padding));
+        return data.get();
+    }
+
+    void commit(uint64_t advance) {
+        head.store(head.load(std::memory_order_relaxed) + advance, std::memory_order_release);
+    }
+};
+
+class Logger {
+public:
+    static Logger& instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    uint32_t register_site(CallSite& site, DecodeFn decode, const char* signature) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t id = site.id.load(std::memory_order_relaxed);
+        if (id != 0) {
+            return id;
+        }
+        id = format_count_.load(std::memory_order_relaxed);
+        if (id >= MAX_FORMATS) {
+            // Out of format slots: the call site is permanently disabled
+            site.id.store(PADDING_ID, std::memory_order_release);
+            return PADDING_ID;
+        }
+        formats_[id].fmt = site.fmt;
+        formats_[id].signature = signature;
+        formats_[id].level = site.level;
+        formats_[id].decode = decode;
+        format_count_.store(id + 1, std::memory_order_release);
+        site.id.store(id, std::memory_order_release);
+        return id;
+    }
+
+    ThreadBuffer* create_buffer() {
+        std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+        ThreadBuffer* raw = buffer.get();
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffers_.push_back(std::move(buffer));
+        return raw;
+    }
+
+    /// Redirects text output (default stdout). The stream is not closed by the logger.
+    void set_output(FILE* stream) {
+        std::lock_guard<std::mutex> lock(output_mutex_);
+        output_ = stream;
+        binary_ = false;
+    }
+
+    /**
+     * Switches to the compact binary format, written to `stream` from now on.
+     * The stream should be freshly opened; it is not closed by the logger.
+     */
+    void set_binary_output(FILE* stream) {
+        std::lock_guard<std::mutex> lock(output_mutex_);
+        output_ = stream;
+        binary_ = true;
+        start_binary_stream();
+    }
+
+    /// Blocks until everything logged before the call has been written.
+    void flush() {
+        std::vector<std::pair<ThreadBuffer*, uint64_t> > targets;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++flushing_; // drain() keeps retired buffers alive until we are done with them
+            for (auto& buffer : buffers_) {
+                targets.push_back(std::make_pair(buffer.get(), buffer->head.load(std::memory_order_acquire)));
+            }
+        }
+        for (auto& target : targets) {
+            while (target.first->tail.load(std::memory_order_acquire) < target.second) {
+                std::this_thread::sleep_for(std::chrono::microseconds(FLUSH_INTERVAL_US / 4));
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --flushing_;
+        }
+        std::lock_guard<std::mutex> lock(output_mutex_);
+        std::fflush(output_);
+    }
+
+private:
+    static constexpr uint32_t DROP_RECORD = PADDING_ID; // Pending::format_id of a drop report
+
+    struct Pending {
+        uint64_t tsc;
+        ThreadBuffer* buffer;
+        uint32_t format_id;
+        std::size_t offset;  // Formatted text, or encoded arguments in binary mode
+        std::size_t length;
+    };
+
+    Logger()
+        : flushing_(0), format_count_(1), output_(stdout), binary_(false), owned_output_(nullptr), stop_(false),
+          cached_second_(-1), last_binary_tsc_(0), next_thread_index_(1), binary_stream_(0) {
+        formats_[0].fmt = "";
+        formats_[0].signature = "";
+        formats_[0].level = LOG_LEVEL_INFO;
+        formats_[0].decode = nullptr;
+        TscCalibration::get();
+
+        const char* binary_path = std::getenv("ASYNC_LOG_BINARY");
+        if (binary_path != nullptr && *binary_path != '\0') {
+            owned_output_ = std::fopen(binary_path, "wb");
+            if (owned_output_ != nullptr) {
+                output_ = owned_output_;
+                binary_ = true;
+                start_binary_stream();
+            } else {
+                std::perror("ASYNC_LOG_BINARY");
+            }
+        }
+        backend_ = std::thread(&Logger::run, this);
+    }
+
+    ~Logger() {
+        stop_.store(true, std::memory_order_release);
+        if (backend_.joinable()) {
+            backend_.join();
+        }
+        if (owned_output_ != nullptr) {
+            std::fclose(owned_output_);
+        }
+    }
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    void run() {
+        // Started after RuntimeConfig::apply(); keep off the hot path's CPUs and priority
+        ipc::apply_housekeeping();
+        while (!stop_.load(std::memory_order_acquire)) {
+            if (!drain()) {
+                std::this_thread::sleep_for(std::chrono::microseconds(FLUSH_INTERVAL_US));
+            }
+        }
+        while (drain()) {
+        }
+    }
+
+    // Formats and writes everything currently published. Returns false if idle.
+    bool drain() {
+        std::vector<ThreadBuffer*> buffers;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto it = buffers_.begin(); it != buffers_.end();) {
+                ThreadBuffer* buffer = it->get();
+                bool empty = buffer->tail.load(std::memory_order_relaxed) ==
+                             buffer->head.load(std::memory_order_acquire);
+                if (empty && flushing_ == 0 && buffer->retired.load(std::memory_order_acquire)) {
+                    it = buffers_.erase(it);
+                    continue;
+                }
+                buffers.push_back(buffer);
+                ++it;
+            }
+        }
+
+        pending_.clear();
+        text_.clear();
+        consumed_.clear();
+        {
+            // Held for the whole pass so the output mode cannot change under it
+            std::lock_guard<std::mutex> lock(output_mutex_);
+            for (ThreadBuffer* buffer : buffers) {
+                drain_buffer(*buffer);
+            }
+            if (pending_.empty()) {
+                release(consumed_);
+                return false;
+            }
+
+            std::stable_sort(pending_.begin(), pending_.end(),
+                             [](const Pending& a, const Pending& b) { return a.tsc < b.tsc; });
+
+            out_.clear();
+            if (binary_) {
+                encode_binary();
+            } else {
+                encode_text();
+            }
+            std::fwrite(out_.data(), 1, out_.size(), output_);
+            std::fflush(output_);
+        }
+        // Only hand the space back once the text is written, so flush() can rely on tail
+        release(consumed_);
+        return true;
+    }
+
+    static void release(const std::vector<std::pair<ThreadBuffer*, uint64_t> >& consumed) {
+        for (const auto& entry : consumed) {
+            entry.first->tail.store(entry.second, std::memory_order_release);
+        }
+    }
+
+    // Caller holds output_mutex_
+    void drain_buffer(ThreadBuffer& buffer) {
+        uint64_t t = buffer.tail.load(std::memory_order_relaxed);
+        uint64_t h = buffer.head.load(std::memory_order_acquire);
+        uint32_t known_formats = format_count_.load(std::memory_order_acquire);
+
+        while (t < h) {
+            const char* record = buffer.data.get() + (t % THREAD_BUFFER_SIZE);
+            RecordHeader header;
+            std::memcpy(&header, record, sizeof(header));
+            if (header.format_id != PADDING_ID && header.format_id < known_formats) {
+                const FormatEntry& entry = formats_[header.format_id];
+                Pending pending = {header.tsc, &buffer, header.format_id, text_.size(), 0};
+                if (binary_) {
+                    encode_binary_args(entry.signature, record + sizeof(header), text_);
+                } else {
+                    entry.decode(entry.fmt, record + sizeof(header), text_);
+                }
+                pending.length = text_.size() - pending.offset;
+                pending_.push_back(pending);
+            }
+            t += header.size;
+        }
+        consumed_.push_back(std::make_pair(&buffer, t));
+
+        uint64_t dropped = buffer.dropped.load(std::memory_order_relaxed);
+        if (dropped != buffer.reported_drops) {
+            Pending pending = {read_tsc(), &buffer, DROP_RECORD, 0, dropped - buffer.reported_drops};
+            pending_.push_back(pending);
+            buffer.reported_drops = dropped;
+        }
+    }
+
+    // Caller holds output_mutex_
+    void encode_text() {
+        const TscCalibration& clock = TscCalibration::get();
+        for (const Pending& record : pending_) {
+            if (record.format_id == DROP_RECORD) {
+                append_prefix(clock.to_epoch_ns(record.tsc), record.buffer->thread_id, LOG_LEVEL_WARN);
+                append_format(out_, "[async_log] %llu records dropped, thread buffer full\n",
+                              static_cast<unsigned long long>(record.length));
+                continue;
+            }
+            append_prefix(clock.to_epoch_ns(record.tsc), record.buffer->thread_id, formats_[record.format_id].level);
+            out_.append(text_, record.offset, record.length);
+            out_ += '\n';
+        }
+    }
+
+    // Caller holds output_mutex_
+    void encode_binary() {
+        for (const Pending& record : pending_) {
+            ThreadBuffer& buffer = *record.buffer;
+            if (buffer.binary_stream != binary_stream_) {
+                buffer.binary_index = next_thread_index_++;
+                buffer.binary_stream = binary_stream_;
+                out_ += static_cast<char>(binlog::TAG_THREAD);
+                binlog::put_varint(out_, buffer.binary_index);
+                binlog::put_varint(out_, buffer.thread_id);
+            }
+
+            if (record.format_id == DROP_RECORD) {
+                out_ += static_cast<char>(binlog::TAG_DROPS);
+                binlog::put_varint(out_, buffer.binary_index);
+                binlog::put_varint(out_, record.length);
+                continue;
+            }
+
+            if (record.format_id >= binary_formats_.size()) {
+                binary_formats_.resize(record.format_id + 1, false);
+            }
+            if (!binary_formats_[record.format_id]) {
+                const FormatEntry& entry = formats_[record.format_id];
+                std::size_t signature_length = std::strlen(entry.signature);
+                std::size_t format_length = std::strlen(entry.fmt);
+                out_ += static_cast<char>(binlog::TAG_FORMAT);
+                binlog::put_varint(out_, record.format_id);
+                out_ += static_cast<char>(entry.level);
+                binlog::put_varint(out_, signature_length);
+                out_.append(entry.signature, signature_length);
+                binlog::put_varint(out_, format_length);
+                out_.append(entry.fmt, format_length);
+                binary_formats_[record.format_id] = true;
+            }
+
+            out_ += static_cast<char>(binlog::TAG_RECORD);
+            binlog::put_varint(out_, record.format_id);
+            binlog::put_varint(out_, buffer.binary_index);
+            binlog::put_varint(out_, binlog::zigzag(static_cast<int64_t>(record.tsc - last_binary_tsc_)));
+            last_binary_tsc_ = record.tsc;
+            out_.append(text_, record.offset, record.length);
+        }
+    }
+
+    // Re-encodes the raw in-memory arguments as varints, driven by the signature
+    static void encode_binary_args(const char* signature, const char* p, std::string& out) {
+        for (; *signature != '\0'; ++signature) {
+            char tag = *signature;
+            if (tag == 's') {
+                uint32_t length;
+                std::memcpy(&length, p, sizeof(length));
+                binlog::put_varint(out, length);
+                out.append(p + sizeof(length), length);
+                p += sizeof(length) + length;
+            } else if (tag == 'f' || tag == 'd') {
+                out.append(p, binlog::tag_size(tag));
+                p += binlog::tag_size(tag);
+            } else {
+                uint64_t value = binlog::load_integer(p, tag);
+                binlog::put_varint(out, binlog::tag_signed(tag) ? binlog::zigzag(static_cast<int64_t>(value)) : value);
+                p += binlog::tag_size(tag);
+            }
+        }
+    }
+
+    // Caller holds output_mutex_ (or is the constructor)
+    void start_binary_stream() {
+        const TscCalibration& clock = TscCalibration::get();
+        binlog::FileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, binlog::MAGIC, sizeof(header.magic));
+        header.version = binlog::VERSION;
+        header.tsc_base = clock.tsc_base;
+        header.epoch_ns_base = clock.epoch_ns_base;
+        header.ns_per_tick = clock.ns_per_tick;
+        std::fwrite(&header, sizeof(header), 1, output_);
+        std::fflush(output_);
+
+        // A new stream needs its own format and thread definitions
+        binary_formats_.clear();
+        last_binary_tsc_ = clock.tsc_base;
+        next_thread_index_ = 1;
+        ++binary_stream_;
+    }
+
+    void append_prefix(int64_t epoch_ns, unsigned long thread_id, int level) {
+        time_t second = static_cast<time_t>(epoch_ns / 1000000000);
+        if (second != cached_second_) {
+            struct tm timeinfo;
+            localtime_r(&second, &timeinfo);
+            char date[32];
+            std::size_t length = std::strftime(date, sizeof(date), "[%Y-%m-%d %H:%M:%S", &timeinfo);
+            cached_date_.assign(date, length);
+            cached_second_ = second;
+        }
+        char suffix[64];
+        int length = std::snprintf(suffix, sizeof(suffix), ".%03d][Thread-%lu][%s] ",
+                                   static_cast<int>((epoch_ns / 1000000) % 1000), thread_id,
+                                   log_level_name(level));
+        out_ += cached_date_;
+        out_.append(suffix, length);
+    }
+
+    std::mutex mutex_;                       // Guards buffers_, flushing_ and registration
+    std::vector<std::unique_ptr<ThreadBuffer> > buffers_;
+    int flushing_;                           // flush() calls polling buffers; none may be freed meanwhile
+    FormatEntry formats_[MAX_FORMATS];
+    std::atomic<uint32_t> format_count_;
+
+    std::mutex output_mutex_;                // Guards the output fields and binary stream state
+    FILE* output_;
+    bool binary_;
+    FILE* owned_output_;                     // Opened from ASYNC_LOG_BINARY
+
+    std::atomic<bool> stop_;
+    std::thread backend_;
+
+    // Backend-only state
+    std::vector<Pending> pending_;
+    std::vector<std::pair<ThreadBuffer*, uint64_t> > consumed_;
+    std::string text_;
+    std::string out_;
+    time_t cached_second_;
+    std::string cached_date_;
+    std::vector<bool> binary_formats_;       // Format ids already defined in the binary stream
+    uint64_t last_binary_tsc_;
+    uint32_t next_thread_index_;
+    uint32_t binary_stream_;
+};
+
+struct ThreadBufferHolder {
+    ThreadBuffer* buffer = nullptr;
+    ~ThreadBufferHolder() {
+        if (buffer != nullptr) {
+            buffer->retired.store(true, std::memory_order_release);
+        }
+    }
+};
+
+inline ThreadBuffer* local_buffer() {
+    static thread_local ThreadBufferHolder holder;
+    if (holder.buffer == nullptr) {
+        holder.buffer = Logger::instance().create_buffer();
+    }
+    return holder.buffer;
+}
+
+inline std::size_t encoded_size() { return 0; }
+
+template <typename T, typename... Rest>
+inline std::size_t encoded_size(const T& first, const Rest&... rest) {
+    return ArgCodec<typename std::decay<T>::type>::size(first) + encoded_size(rest...);
+}
+
+inline char* encode_args(char* p) { return p; }
+
+template <typename T, typename... Rest>
+inline char* encode_args(char* p, const T& first, const Rest&... rest) {
+    p = ArgCodec<typename std::decay<T>::type>::encode(p, first);
+    return encode_args(p, rest...);
+}
+
+template <typename... Args>
+inline void log(CallSite& site, const Args&... args) {
+    uint32_t id = site.id.load(std::memory_order_acquire);
+    if (id == 0) {
+        typedef Decoder<typename std::decay<Args>::type...> SiteDecoder;
+        id = Logger::instance().register_site(site, &SiteDecoder::format, SiteDecoder::signature());
+    }
+
+    uint64_t tsc = read_tsc();
+    ThreadBuffer* buffer = local_buffer();
+    std::size_t size = (sizeof(RecordHeader) + encoded_size(args...) + 15) & ~static_cast<std::size_t>(15);
+    uint64_t advance = 0;
+    char* record = (size <= THREAD_BUFFER_SIZE / 2 && id != PADDING_ID) ? buffer->reserve(size, advance) : nullptr;
+    if (record == nullptr) {
+        buffer->dropped.store(buffer->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+
+    RecordHeader header = {static_cast<uint32_t>(size), id, tsc};
+    std::memcpy(record, &header, sizeof(header));
+    encode_args(record + sizeof(header), args...);
+    buffer->commit(advance);
+}
+
+/// Blocks until all records logged so far are written.
+inline void flush() {
+    Logger::instance().flush();
+}
+
+} // namespace async_log
+
+/**
+ * Logs a printf-style message at `level` without formatting on the calling
+ * thread. The format must be a string literal; arguments are checked by the
+ * compiler.
+ */
+#define ASYNC_LOG_AT(level, fmt, ...)                                \
+    do {                                                             \
+        static async_log::CallSite async_log_site_(fmt, level);      \
+        if (false) async_log::check_format(fmt, ##__VA_ARGS__);      \
+        async_log::log(async_log_site_, ##__VA_ARGS__);              \
+    } while (0)
+
+// Compiled-out statement: format still checked, arguments never evaluated
+#define ASYNC_LOG_DISABLED(fmt, ...)                                 \
+    do {                                                             \
+        if (false) async_log::check_format(fmt, ##__VA_ARGS__);      \
+    } while (0)
+
+#if LOG_ACTIVE_LEVEL <= LOG_LEVEL_TRACE
+#define LOG_TRACE(fmt, ...) ASYNC_LOG_AT(LOG_LEVEL_TRACE, fmt, ##__VA_ARGS__)
+#else
+#define LOG_TRACE(fmt, ...) ASYNC_LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_ACTIVE_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(fmt, ...) ASYNC_LOG_AT(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(fmt, ...) ASYNC_LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_ACTIVE_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(fmt, ...) ASYNC_LOG_AT(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define LOG_INFO(fmt, ...) ASYNC_LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_ACTIVE_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(fmt, ...) ASYNC_LOG_AT(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#else
+#define LOG_WARN(fmt, ...) ASYNC_LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_ACTIVE_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(fmt, ...) ASYNC_LOG_AT(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(fmt, ...) ASYNC_LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+
+// Unleveled form, same as LOG_INFO
+#define ASYNC_LOG(fmt, ...) LOG_INFO(fmt, ##__VA_ARGS__)
+
+#endif // ASYNC_LOGGER_H
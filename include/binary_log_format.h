@@ -0,0 +1,139 @@
+#ifndef BINARY_LOG_FORMAT_H
+#define BINARY_LOG_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+/**
+ * @brief On-disk format written by the async logger in binary mode and read
+ *        back by tools/log_decoder.
+ *
+ * @details The file starts with a FileHeader holding the TSC calibration, so
+ *          the decoder can turn timestamps into wall-clock time. It is then a
+ *          stream of entries, each introduced by a one-byte tag:
+ *
+ *            'F' format : id, level, signature, format string (once per id)
+ *            'T' thread : index, thread id (once per thread)
+ *            'R' record : id, thread index, zigzag TSC delta, arguments
+ *            'D' drops  : thread index, number of records dropped
+ *
+ *          Integers are LEB128 varints (signed ones zigzag-encoded first), so
+ *          a typical record is a few bytes plus its string arguments, against
+ *          roughly a hundred bytes for the formatted text line.
+ *
+ *          The signature has one character per argument:
+ *            b h i l  signed 8/16/32/64-bit     B H I L  unsigned 8/16/32/64-bit
+ *            f d      float/double              p        pointer
+ *            s        string (varint length + bytes)
+ */
+namespace binlog {
+
+constexpr char MAGIC[8] = {'A', 'L', 'O', 'G', 'B', 'I', 'N', '1'};
+constexpr uint32_t VERSION = 1;
+
+constexpr uint8_t TAG_FORMAT = 'F';
+constexpr uint8_t TAG_THREAD = 'T';
+constexpr uint8_t TAG_RECORD = 'R';
+constexpr uint8_t TAG_DROPS  = 'D';
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t tsc_base;
+    int64_t epoch_ns_base;
+    double ns_per_tick;
+};
+
+// Signature character for one argument type (already decayed)
+template <typename T, typename Enable = void>
+struct TypeTag;
+
+template <typename T>
+struct TypeTag<T, typename std::enable_if<std::is_integral<T>::value>::type> {
+    static constexpr char value = std::is_signed<T>::value
+        ? (sizeof(T) == 1 ? 'b' : sizeof(T) == 2 ? 'h' : sizeof(T) == 4 ? 'i' : 'l')
+        : (sizeof(T) == 1 ? 'B' : sizeof(T) == 2 ? 'H' : sizeof(T) == 4 ? 'I' : 'L');
+};
+
+template <typename T>
+struct TypeTag<T, typename std::enable_if<std::is_enum<T>::value>::type>
+    : TypeTag<typename std::underlying_type<T>::type> {};
+
+template <> struct TypeTag<float>  { static constexpr char value = 'f'; };
+template <> struct TypeTag<double> { static constexpr char value = 'd'; };
+template <> struct TypeTag<const char*> { static constexpr char value = 's'; };
+template <> struct TypeTag<char*> { static constexpr char value = 's'; };
+
+template <typename T>
+struct TypeTag<T, typename std::enable_if<std::is_pointer<T>::value &&
+                                          !std::is_same<T, const char*>::value &&
+                                          !std::is_same<T, char*>::value>::type> {
+    static constexpr char value = 'p';
+};
+
+// Size of the raw in-memory encoding for a fixed-size tag (0 for strings)
+inline std::size_t tag_size(char tag) {
+    switch (tag) {
+        case 'b': case 'B': return 1;
+        case 'h': case 'H': return 2;
+        case 'i': case 'I': case 'f': return 4;
+        case 'l': case 'L': case 'd': return 8;
+        case 'p': return sizeof(void*);
+        default: return 0;
+    }
+}
+
+inline bool tag_signed(char tag) {
+    return tag == 'b' || tag == 'h' || tag == 'i' || tag == 'l';
+}
+
+inline void put_varint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+inline uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+/// Reads a varint; returns false on truncated input.
+inline bool get_varint(const char*& p, const char* end, uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(*p++);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Loads a raw fixed-size integer argument of the given tag, widened to 64 bits.
+inline uint64_t load_integer(const char* p, char tag) {
+    switch (tag) {
+        case 'b': { int8_t v; std::memcpy(&v, p, 1); return static_cast<uint64_t>(static_cast<int64_t>(v)); }
+        case 'h': { int16_t v; std::memcpy(&v, p, 2); return static_cast<uint64_t>(static_cast<int64_t>(v)); }
+        case 'i': { int32_t v; std::memcpy(&v, p, 4); return static_cast<uint64_t>(static_cast<int64_t>(v)); }
+        case 'B': { uint8_t v; std::memcpy(&v, p, 1); return v; }
+        case 'H': { uint16_t v; std::memcpy(&v, p, 2); return v; }
+        case 'I': { uint32_t v; std::memcpy(&v, p, 4); return v; }
+        case 'p': { uintptr_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+        default:  { uint64_t v; std::memcpy(&v, p, 8); return v; }
+    }
+}
+
+} // namespace binlog
+
+#endif // BINARY_LOG_FORMAT_H
@@ -0,0 +1,184 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include "futex.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Bounded multi-producer/multi-consumer queue for handing values
+ *        between threads of one process (Vyukov's array queue).
+ *
+ * @details Every cell carries a sequence number that says whose turn it is:
+ *          `pos` when the cell is free for the producer that claims position
+ *          `pos`, `pos + 1` once that producer has filled it, and
+ *          `pos + Capacity` after the consumer emptied it for the next lap.
+ *          Producers and consumers claim positions with one CAS on their own
+ *          counter and never touch each other's, so a push and a pop only
+ *          meet on the cell they hand over.
+ *
+ *          push()/pop() first try, then spin briefly, and only park on a
+ *          futex when the queue is really full or empty. The other side pays
+ *          for a wake-up only when someone is parked.
+ *
+ * @tparam T        Element type; move-only types (e.g. std::unique_ptr) work.
+ * @tparam Capacity Number of cells, a power of two.
+ *
+ * @note The queue embeds its cells, so give large queues static storage or
+ *       put them in a member, not on a small thread stack.
+ */
+template <typename T, std::size_t Capacity>
+class BoundedQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two of at least 2");
+    static_assert(std::is_nothrow_move_constructible<T>::value,
+                  "Elements are moved in and out of cells and must not throw doing so");
+
+public:
+    static constexpr int SPIN_ROUNDS = 128; // Retries before a blocking call parks
+
+    BoundedQueue()
+        : enqueue_pos_(0), dequeue_pos_(0) {
+        not_empty_.init();
+        not_full_.init();
+        for (std::size_t i = 0; i < Capacity; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Destroys whatever is still queued; no other thread may use the queue by now
+    ~BoundedQueue() {
+        uint64_t end = enqueue_pos_.load(std::memory_order_acquire);
+        for (uint64_t pos = dequeue_pos_.load(std::memory_order_acquire); pos != end; ++pos) {
+            cells_[pos & (Capacity - 1)].value()->~T();
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // Plain new only guarantees 16-byte alignment before C++17, which would
+    // put the padded counters back on shared cache lines
+    static void* operator new(std::size_t size) {
+        void* ptr = nullptr;
+        if (posix_memalign(&ptr, alignof(BoundedQueue), size) != 0) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+
+    static void operator delete(void* ptr) { std::free(ptr); }
+
+    // Returns false, leaving `value` untouched, when the queue is full
+    template <typename U>
+    bool try_push(U&& value) {
+        Cell* cell;
+        uint64_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells_[pos & (Capacity - 1)];
+            uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(sequence - pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // The cell still holds last lap's value
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (cell->storage()) T(std::forward<U>(value));
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // Returns false when the queue is empty
+    bool try_pop(T& out) {
+        Cell* cell;
+        uint64_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells_[pos & (Capacity - 1)];
+            uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(sequence - (pos + 1));
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // Not filled yet
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        T* value = cell->value();
+        out = std::move(*value);
+        value->~T();
+        cell->sequence.store(pos + Capacity, std::memory_order_release);
+        not_full_.notify_one();
+        return true;
+    }
+
+    // Blocks while the queue is full
+    template <typename U>
+    void push(U&& value) {
+        while (!try_push(std::forward<U>(value))) {
+            not_full_.wait_until([&]() { return !full(); }, SPIN_ROUNDS);
+        }
+    }
+
+    // Blocks while the queue is empty
+    void pop(T& out) {
+        while (!try_pop(out)) {
+            not_empty_.wait_until([&]() { return !empty(); }, SPIN_ROUNDS);
+        }
+    }
+
+    // Approximate under concurrency, exact when quiescent
+    std::size_t size() const {
+        uint64_t tail = dequeue_pos_.load(std::memory_order_acquire);
+        uint64_t head = enqueue_pos_.load(std::memory_order_acquire);
+        return (head > tail) ? static_cast<std::size_t>(head - tail) : 0;
+    }
+
+    static constexpr std::size_t capacity() { return Capacity; }
+
+private:
+    struct Cell {
+        std::atomic<uint64_t> sequence;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type data;
+
+        void* storage() { return &data; }
+        T* value() { return reinterpret_cast<T*>(&data); }
+    };
+
+    // The cell at the producer position is still occupied
+    bool full() const {
+        uint64_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        uint64_t sequence = cells_[pos & (Capacity - 1)].sequence.load(std::memory_order_acquire);
+        return static_cast<int64_t>(sequence - pos) < 0;
+    }
+
+    // The cell at the consumer position has not been filled yet
+    bool empty() const {
+        uint64_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        uint64_t sequence = cells_[pos & (Capacity - 1)].sequence.load(std::memory_order_acquire);
+        return static_cast<int64_t>(sequence - (pos + 1)) < 0;
+    }
+
+    alignas(64) std::atomic<uint64_t> enqueue_pos_;
+    alignas(64) std::atomic<uint64_t> dequeue_pos_;
+    alignas(64) FutexEvent not_empty_;   // Consumers park here
+    alignas(64) FutexEvent not_full_;    // Producers park here
+    alignas(64) Cell cells_[Capacity];
+};
+
+#endif // BOUNDED_QUEUE_H
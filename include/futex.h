@@ -0,0 +1,111 @@
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include <atomic>
+#include <cstdint>
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Thin wrappers over the Linux futex syscall for parking threads on a
+ *        32-bit atomic word.
+ *
+ * @details futex_wait() only sleeps if the word still holds `expected` when
+ *          the kernel checks it, so a waker that changes the word before
+ *          calling futex_wake() can never be missed. Spurious returns are
+ *          possible; callers re-check their condition in a loop.
+ *
+ *          Words inside a MAP_SHARED mapping must pass `shared = true` so the
+ *          kernel keys the wait queue on the physical page instead of the
+ *          process's address space.
+ */
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex words must be plain 32-bit");
+
+inline void futex_wait(std::atomic<uint32_t>* word, uint32_t expected, bool shared = false) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word),
+            shared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+// Wakes up to `count` threads parked on `word`
+inline void futex_wake(std::atomic<uint32_t>* word, int count = INT_MAX, bool shared = false) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word),
+            shared ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+// Spin-wait hint for the few iterations before parking
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#endif
+}
+
+/**
+ * @brief Parking spot for threads waiting on a condition that other threads
+ *        make true without holding a lock (queue not empty, not full, ...).
+ *
+ * @details Waiters spin on the condition first and only park when it stays
+ *          false. The notifying side pays one fence and one load unless
+ *          someone is parked. The waker, not the waiter, takes a thread off
+ *          the `waiting` count, so a thread that was woken but has not run
+ *          yet does not draw more wake-ups; a count left by a waiter that
+ *          found the condition true and never slept only costs one spare wake.
+ *
+ *          Zero-filled memory is a valid FutexEvent, so it can be embedded in
+ *          a shared memory segment (pass `shared = true` there).
+ */
+struct FutexEvent {
+    std::atomic<uint32_t> epoch;   // Futex word, bumped on every wake
+    std::atomic<uint32_t> waiting; // Parked threads not yet woken (may overcount)
+
+    void init() {
+        epoch.store(0, std::memory_order_relaxed);
+        waiting.store(0, std::memory_order_relaxed);
+    }
+
+    // Returns the spin rounds made before the condition held or the thread parked
+    template <typename Ready>
+    int wait_until(Ready ready, int spin_rounds, bool shared = false) {
+        for (int spin = 0; spin < spin_rounds; ++spin) {
+            if (ready()) {
+                return spin;
+            }
+            cpu_relax();
+        }
+        uint32_t seen = epoch.load(std::memory_order_acquire);
+        waiting.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst); // Pairs with the fence in notify_one()/notify_all()
+        if (!ready()) {
+            futex_wait(&epoch, seen, shared);
+        }
+        return spin_rounds;
+    }
+
+    // Call after making the condition true
+    void notify_one(bool shared = false) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint32_t count = waiting.load(std::memory_order_relaxed);
+        while (count != 0 && !waiting.compare_exchange_weak(count, count - 1, std::memory_order_relaxed)) {
+        }
+        if (count != 0) {
+            epoch.fetch_add(1, std::memory_order_release);
+            futex_wake(&epoch, 1, shared);
+        }
+    }
+
+    // Same, but wakes every parked thread: for conditions all waiters share
+    void notify_all(bool shared = false) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed) != 0 && waiting.exchange(0, std::memory_order_relaxed) != 0) {
+            epoch.fetch_add(1, std::memory_order_release);
+            futex_wake(&epoch, INT_MAX, shared);
+        }
+    }
+};
+
+#endif // FUTEX_H
@@ -0,0 +1,187 @@
+#ifndef IPC_CHANNEL_H
+#define IPC_CHANNEL_H
+
+#include "futex.h"
+#include "ipc/metrics.h"
+#include "ipc/shared_segment.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <sched.h>
+
+#if ATOMIC_LLONG_LOCK_FREE != 2
+#error "Channels need lock-free 64-bit atomics to work across processes"
+#endif
+
+namespace ipc {
+
+/**
+ * @brief Wait policy that never sleeps in the kernel: spins with a pause
+ *        hint, then yields the CPU. Lowest latency when both sides have a
+ *        core of their own; burns CPU while idle.
+ *
+ * Waiters of either policy add the rounds they spun to `spins` (a
+ * RoleMetrics counter) when it is given.
+ */
+struct SpinWait {
+    struct Waiter {
+        void init() {}
+
+        template <typename Ready>
+        void wait_until(Ready ready, std::atomic<uint64_t>* spins = nullptr) {
+            unsigned rounds = 0;
+            for (; !ready(); ++rounds) {
+                if (rounds < 64) {
+                    cpu_relax();
+                } else {
+                    sched_yield();
+                }
+            }
+            if (spins != nullptr) {
+                metric_add(*spins, rounds);
+            }
+        }
+
+        void notify() {}
+    };
+};
+
+/**
+ * @brief Wait policy that spins briefly, then parks on a process-shared
+ *        futex. Idle consumers cost nothing; the other side only makes a
+ *        syscall when someone is actually parked.
+ */
+struct FutexWait {
+    static constexpr int SPIN_ROUNDS = 128;
+
+    struct Waiter {
+        FutexEvent event;
+
+        void init() { event.init(); }
+
+        template <typename Ready>
+        void wait_until(Ready ready, std::atomic<uint64_t>* spins = nullptr) {
+            uint64_t rounds = 0;
+            while (!ready()) {
+                rounds += static_cast<uint64_t>(event.wait_until(ready, SPIN_ROUNDS, true));
+            }
+            if (spins != nullptr) {
+                metric_add(*spins, rounds);
+            }
+        }
+
+        void notify() { event.notify_one(true); }
+    };
+};
+
+/**
+ * @brief Typed single-producer/single-consumer channel that lives in shared
+ *        memory (no pointers; zero-filled memory plus init() is a valid empty
+ *        channel).
+ *
+ * @details The producer owns `head`, the consumer owns `tail`; each side keeps
+ *          a private cached copy of the other side's index so the shared
+ *          cache line is only read when the cached value says full/empty.
+ *          How a blocked push()/pop() waits is chosen by `WaitPolicy`.
+ *
+ * @tparam T          Trivially copyable message type.
+ * @tparam Capacity   Number of slots, a power of two.
+ * @tparam WaitPolicy SpinWait or FutexWait.
+ */
+template <typename T, std::size_t Capacity, typename WaitPolicy = FutexWait>
+struct Channel {
+    static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Channel messages are copied between processes byte for byte");
+    static_assert(alignof(T) <= 64, "Message alignment must not exceed a cache line");
+
+    typedef T message_type;
+    typedef typename WaitPolicy::Waiter waiter_type;
+
+    alignas(64) std::atomic<uint64_t> head; // Next slot to write
+    uint64_t cached_tail;                   // Producer's view of tail
+    alignas(64) std::atomic<uint64_t> tail; // Next slot to read
+    uint64_t cached_head;                   // Consumer's view of head
+    alignas(64) waiter_type not_empty;      // Consumer parks here
+    alignas(64) waiter_type not_full;       // Producer parks here
+    alignas(64) T slots[Capacity];
+
+    static constexpr std::size_t capacity() { return Capacity; }
+
+    void init() {
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+        cached_tail = 0;
+        cached_head = 0;
+        not_empty.init();
+        not_full.init();
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    bool try_push(const T& value) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        if (h - cached_tail == Capacity) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (h - cached_tail == Capacity) {
+                return false;
+            }
+        }
+        slots[h & (Capacity - 1)] = value;
+        head.store(h + 1, std::memory_order_release);
+        not_empty.notify();
+        return true;
+    }
+
+    bool try_pop(T& out) {
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        if (t == cached_head) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (t == cached_head) {
+                return false;
+            }
+        }
+        out = slots[t & (Capacity - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        not_full.notify();
+        return true;
+    }
+
+    /// Blocks, as the wait policy dictates, while the channel is full; spin rounds go to `spins`.
+    void push(const T& value, std::atomic<uint64_t>* spins = nullptr) {
+        while (!try_push(value)) {
+            not_full.wait_until([this]() {
+                return head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire) < Capacity;
+            }, spins);
+        }
+    }
+
+    /// Blocks, as the wait policy dictates, while the channel is empty; spin rounds go to `spins`.
+    void pop(T& out, std::atomic<uint64_t>* spins = nullptr) {
+        while (!try_pop(out)) {
+            not_empty.wait_until([this]() {
+                return head.load(std::memory_order_acquire) != tail.load(std::memory_order_relaxed);
+            }, spins);
+        }
+    }
+};
+
+/// Compile-time checks every shared-memory channel must pass.
+template <typename ChannelType>
+struct ChannelLayout {
+    typedef typename ChannelType::message_type message_type;
+
+    static_assert(is_shm_placeable<ChannelType>::value,
+                  "Channels must be placeable in shared memory");
+    static_assert(alignof(ChannelType) == 64, "Channels start on a cache line");
+    static_assert(sizeof(ChannelType) % 64 == 0, "Channels occupy whole cache lines");
+    static_assert(sizeof(ChannelType) >= 4 * 64 + ChannelType::capacity() * sizeof(message_type),
+                  "Producer, consumer and waiter state must sit on separate cache lines");
+
+    static constexpr bool value = true;
+};
+
+} // namespace ipc
+
+#endif // IPC_CHANNEL_H
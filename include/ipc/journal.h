@@ -0,0 +1,462 @@
+#ifndef IPC_JOURNAL_H
+#define IPC_JOURNAL_H
+
+#include "futex.h"
+#include "ipc/metrics.h"
+#include "ipc/runtime_config.h"
+#include "ipc/shared_segment.h"
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+namespace ipc {
+
+constexpr uint32_t JOURNAL_MAGIC = 0x4A524E4C; // "JRNL"
+constexpr uint32_t JOURNAL_VERSION = 1;
+
+/**
+ * @brief Control block of a journal, mapped from `<dir>/journal.head`.
+ *
+ * @details `head` is the offset (record number) the next append gets; every
+ *          record below it is complete, because the writer stores the record
+ *          before publishing `head` with release semantics. `first` is the
+ *          oldest offset whose segment file still exists.
+ */
+struct JournalHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t reserved;
+    uint64_t records_per_segment;
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> first;
+    alignas(64) FutexEvent published; // Readers waiting for head to move park here
+};
+
+static_assert(is_shm_placeable<JournalHeader>::value, "The journal header is mapped by several processes");
+
+namespace journal_detail {
+
+inline std::string header_path(const std::string& dir) { return dir + "/journal.head"; }
+
+inline std::string segment_path(const std::string& dir, uint64_t index) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "/%020llu.seg", static_cast<unsigned long long>(index));
+    return dir + name;
+}
+
+enum FileMode {
+    FILE_READ,   // Existing file, read-only
+    FILE_UPDATE, // Existing file, read-write
+    FILE_CREATE  // Created if missing, preallocated and faulted in
+};
+
+/**
+ * Maps `size` bytes of `path`. FILE_CREATE preallocates the file and faults
+ * every page in, so later stores never wait on the filesystem. Returns
+ * nullptr if the file does not exist (silently) or on error.
+ */
+inline void* map_file(const std::string& path, std::size_t size, FileMode mode) {
+    bool writable = mode != FILE_READ;
+    int fd = open(path.c_str(), mode == FILE_CREATE ? (O_RDWR | O_CREAT) : (writable ? O_RDWR : O_RDONLY), 0644);
+    if (fd == -1) {
+        if (errno != ENOENT) {
+            perror(path.c_str());
+        }
+        return nullptr;
+    }
+    if (mode == FILE_CREATE) {
+        int rc = posix_fallocate(fd, 0, static_cast<off_t>(size));
+        if (rc != 0 && ftruncate(fd, static_cast<off_t>(size)) == -1) {
+            std::fprintf(stderr, "%s: cannot allocate %zu bytes: %s\n", path.c_str(), size, std::strerror(rc));
+            close(fd);
+            return nullptr;
+        }
+    }
+    void* ptr = mmap(nullptr, size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                     MAP_SHARED | (mode == FILE_CREATE ? MAP_POPULATE : 0), fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) {
+        perror("mmap");
+        return nullptr;
+    }
+    return ptr;
+}
+
+} // namespace journal_detail
+
+/**
+ * @brief Appends fixed-size records to a journal: a directory of
+ *        preallocated, memory-mapped segment files plus a shared header.
+ *
+ * @details append() is a copy into the mapped current segment and a release
+ *          store of `head`; it never calls into the filesystem. A background
+ *          roller thread maps the next segment ahead of time, unmaps the ones
+ *          the writer has left and unlinks the oldest ones beyond
+ *          `retain_segments`, advancing `first` before the file disappears.
+ *          If the roller falls behind, append() maps the next segment itself
+ *          and counts a stall.
+ *
+ *          Opening an existing journal with the same record layout resumes
+ *          at its head, so a restarted producer continues the sequence.
+ *
+ * @tparam T Trivially copyable record type.
+ */
+template <typename T>
+class JournalWriter {
+    static_assert(std::is_trivially_copyable<T>::value, "Journal records are written to disk byte for byte");
+
+public:
+    JournalWriter()
+        : header_(nullptr), records_(nullptr), segment_index_(0), stalls_(0),
+          next_records_(nullptr), prepare_index_(0), prepared_index_(0), oldest_index_(0), retain_segments_(0),
+          stop_(false) {}
+
+    ~JournalWriter() { close(); }
+
+    JournalWriter(const JournalWriter&) = delete;
+    JournalWriter& operator=(const JournalWriter&) = delete;
+
+    /**
+     * Creates `dir` and its header if needed, or resumes the journal there.
+     * @return false on I/O errors or if the journal holds a different record layout
+     */
+    bool open(const std::string& dir, uint64_t records_per_segment, uint64_t retain_segments) {
+        close();
+        if (mkdir(dir.c_str(), 0755) == -1 && errno != EEXIST) {
+            perror(dir.c_str());
+            return false;
+        }
+        header_ = static_cast<JournalHeader*>(
+            journal_detail::map_file(journal_detail::header_path(dir), sizeof(JournalHeader), journal_detail::FILE_CREATE));
+        if (header_ == nullptr) {
+            return false;
+        }
+        if (header_->magic == JOURNAL_MAGIC) {
+            if (header_->version != JOURNAL_VERSION || header_->record_size != sizeof(T)) {
+                std::fprintf(stderr, "%s holds records of %u bytes (version %u), expected %zu (version %u)\n",
+                             dir.c_str(), header_->record_size, header_->version, sizeof(T), JOURNAL_VERSION);
+                close();
+                return false;
+            }
+        } else {
+            header_->version = JOURNAL_VERSION;
+            header_->record_size = sizeof(T);
+            header_->records_per_segment = records_per_segment;
+            header_->head.store(0, std::memory_order_relaxed);
+            header_->first.store(0, std::memory_order_relaxed);
+            header_->published.init();
+            std::atomic_thread_fence(std::memory_order_release);
+            header_->magic = JOURNAL_MAGIC;
+        }
+
+        dir_ = dir;
+        retain_segments_ = retain_segments < 2 ? 2 : retain_segments;
+        uint64_t head = header_->head.load(std::memory_order_relaxed);
+        segment_index_ = head / per_segment();
+        oldest_index_ = header_->first.load(std::memory_order_relaxed) / per_segment();
+        records_ = map_segment(segment_index_);
+        if (records_ == nullptr) {
+            close();
+            return false;
+        }
+        stop_ = false;
+        prepare_index_ = segment_index_ + 1;
+        roller_ = std::thread(&JournalWriter::roll, this);
+        return true;
+    }
+
+    void close() {
+        if (roller_.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            wake_roller_.notify_one();
+            roller_.join();
+        }
+        if (records_ != nullptr) {
+            munmap(records_, segment_bytes());
+            records_ = nullptr;
+        }
+        if (next_records_ != nullptr) {
+            munmap(next_records_, segment_bytes());
+            next_records_ = nullptr;
+        }
+        for (T* retired : retired_) {
+            munmap(retired, segment_bytes());
+        }
+        retired_.clear();
+        if (header_ != nullptr) {
+            munmap(header_, sizeof(JournalHeader));
+            header_ = nullptr;
+        }
+    }
+
+    /**
+     * Appends one record at head() and wakes blocked readers.
+     * @return false if the next segment could not be mapped; the record is
+     *         dropped, head() stays put and the next append retries the map
+     */
+    bool append(const T& record) {
+        uint64_t offset = header_->head.load(std::memory_order_relaxed);
+        uint64_t slot = offset % per_segment();
+        if (slot == 0 && offset / per_segment() != segment_index_ && !switch_segment(offset / per_segment())) {
+            return false;
+        }
+        records_[slot] = record;
+        header_->head.store(offset + 1, std::memory_order_release);
+        header_->published.notify_all(true); // Every parked reader wants this record
+        return true;
+    }
+
+    uint64_t head() const { return header_->head.load(std::memory_order_relaxed); }
+    uint64_t first() const { return header_->first.load(std::memory_order_relaxed); }
+
+    /// Segment switches that had to map the file inline because the roller was late.
+    uint64_t stalls() const { return stalls_; }
+
+private:
+    uint64_t per_segment() const { return header_->records_per_segment; }
+    std::size_t segment_bytes() const { return static_cast<std::size_t>(per_segment() * sizeof(T)); }
+
+    T* map_segment(uint64_t index) {
+        return static_cast<T*>(journal_detail::map_file(journal_detail::segment_path(dir_, index), segment_bytes(),
+                                                        journal_detail::FILE_CREATE));
+    }
+
+    // Publish-path side of a roll: take the prepared mapping, hand the old one back.
+    // On failure records_ is null and segment_index_ unchanged, so the next append retries.
+    bool switch_segment(uint64_t index) {
+        T* next = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (next_records_ != nullptr) {
+                if (prepared_index_ == index) {
+                    next = next_records_;
+                } else {
+                    retired_.push_back(next_records_);
+                }
+                next_records_ = nullptr;
+            }
+            if (records_ != nullptr) {
+                retired_.push_back(records_);
+                records_ = nullptr;
+            }
+            prepare_index_ = index + 1;
+        }
+        wake_roller_.notify_one();
+        if (next == nullptr) {
+            ++stalls_;
+            next = map_segment(index);
+            if (next == nullptr) {
+                return false;
+            }
+        }
+        records_ = next;
+        segment_index_ = index;
+        return true;
+    }
+
+    // Roller thread: every filesystem call of the writer after open() happens here
+    void roll() {
+        apply_housekeeping();
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            std::vector<T*> retired;
+            retired.swap(retired_);
+            uint64_t wanted = prepare_index_;
+            bool prepare = next_records_ == nullptr;
+            lock.unlock();
+
+            for (T* records : retired) {
+                msync(records, segment_bytes(), MS_ASYNC);
+                munmap(records, segment_bytes());
+            }
+            T* prepared = prepare ? map_segment(wanted) : nullptr;
+            uint64_t current = wanted - 1;
+            while (current - oldest_index_ >= retain_segments_) {
+                header_->first.store((oldest_index_ + 1) * per_segment(), std::memory_order_release);
+                unlink(journal_detail::segment_path(dir_, oldest_index_).c_str());
+                ++oldest_index_;
+            }
+
+            lock.lock();
+            if (prepared != nullptr) {
+                if (prepare_index_ == wanted) {
+                    next_records_ = prepared;
+                    prepared_index_ = wanted;
+                } else {
+                    retired_.push_back(prepared); // The writer moved on while we were mapping
+                }
+            }
+            if (!stop_ && retired_.empty() && next_records_ != nullptr) {
+                wake_roller_.wait(lock);
+            }
+        }
+    }
+
+    std::string dir_;
+    JournalHeader* header_;
+    T* records_;               // Current segment, written by append()
+    uint64_t segment_index_;
+    uint64_t stalls_;
+
+    // Shared with the roller thread under mutex_
+    std::mutex mutex_;
+    std::condition_variable wake_roller_;
+    T* next_records_;          // Mapped ahead by the roller
+    uint64_t prepare_index_;   // Segment the writer will need next
+    uint64_t prepared_index_;  // Segment next_records_ maps
+    std::vector<T*> retired_;  // Segments to unmap
+    uint64_t oldest_index_;    // Oldest segment file still on disk (roller only)
+    uint64_t retain_segments_;
+    bool stop_;
+    std::thread roller_;
+};
+
+/**
+ * @brief Reads a journal from any offset still on disk, in its own process.
+ *
+ * @details Segment files are mapped read-only one at a time. Records never
+ *          change once published, so reading is a plain copy. A reader that
+ *          falls behind `first` (its segment was rolled away) skips ahead to
+ *          the oldest record still available and counts what it missed.
+ */
+template <typename T>
+class JournalReader {
+    static_assert(std::is_trivially_copyable<T>::value, "Journal records are read from disk byte for byte");
+
+public:
+    static constexpr int SPIN_ROUNDS = 128;
+
+    JournalReader() : header_(nullptr), records_(nullptr), segment_index_(0), position_(0), skipped_(0), failed_(false) {}
+    ~JournalReader() { close(); }
+
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+
+    bool open(const std::string& dir) {
+        close();
+        header_ = static_cast<JournalHeader*>(
+            journal_detail::map_file(journal_detail::header_path(dir), sizeof(JournalHeader), journal_detail::FILE_UPDATE));
+        if (header_ == nullptr) {
+            std::fprintf(stderr, "%s: no journal\n", dir.c_str());
+            return false;
+        }
+        if (header_->magic != JOURNAL_MAGIC || header_->version != JOURNAL_VERSION ||
+            header_->record_size != sizeof(T)) {
+            std::fprintf(stderr, "%s: journal layout does not match this reader\n", dir.c_str());
+            close();
+            return false;
+        }
+        dir_ = dir;
+        position_ = first();
+        return true;
+    }
+
+    void close() {
+        unmap();
+        if (header_ != nullptr) {
+            munmap(header_, sizeof(JournalHeader));
+            header_ = nullptr;
+        }
+    }
+
+    /// Next read returns the record at `offset` (clamped to what is still on disk).
+    void seek(uint64_t offset) { position_ = offset; }
+
+    uint64_t position() const { return position_; }
+    uint64_t head() const { return header_->head.load(std::memory_order_acquire); }
+    uint64_t first() const { return header_->first.load(std::memory_order_acquire); }
+
+    /// Records that were rolled away before this reader got to them.
+    uint64_t skipped() const { return skipped_; }
+
+    /// True once a published segment could not be mapped (e.g. EMFILE); reads then fail.
+    bool failed() const { return failed_; }
+
+    /// Copies the record at position() and advances; false if none is published yet, or if failed().
+    bool try_read(T& out) {
+        failed_ = false;
+        while (true) {
+            if (position_ >= head()) {
+                return false;
+            }
+            uint64_t per_segment = header_->records_per_segment;
+            uint64_t index = position_ / per_segment;
+            if (records_ == nullptr || index != segment_index_) {
+                unmap();
+                records_ = static_cast<const T*>(journal_detail::map_file(
+                    journal_detail::segment_path(dir_, index), per_segment * sizeof(T), journal_detail::FILE_READ));
+                segment_index_ = index;
+            }
+            if (records_ == nullptr) {
+                // Segment rolled away: resume at the oldest record left
+                uint64_t oldest = first();
+                if (oldest <= position_) {
+                    failed_ = true; // Cannot be mapped, or removed behind the writer's back
+                    return false;
+                }
+                skipped_ += oldest - position_;
+                position_ = oldest;
+                continue;
+            }
+            out = records_[position_ % per_segment];
+            ++position_;
+            return true;
+        }
+    }
+
+    /**
+     * Blocks until the next record is published, adding the rounds spun
+     * before parking to `spins` if given.
+     * @return false if it is published but its segment cannot be mapped
+     */
+    bool read(T& out, std::atomic<uint64_t>* spins = nullptr) {
+        while (!try_read(out)) {
+            if (failed_) {
+                std::fprintf(stderr, "%s: cannot map the segment of offset %llu\n", dir_.c_str(),
+                             static_cast<unsigned long long>(position_));
+                return false;
+            }
+            int rounds = header_->published.wait_until([this]() { return head() > position_; }, SPIN_ROUNDS, true);
+            if (spins != nullptr) {
+                metric_add(*spins, static_cast<uint64_t>(rounds));
+            }
+        }
+        return true;
+    }
+
+private:
+    void unmap() {
+        if (records_ != nullptr) {
+            munmap(const_cast<T*>(records_), header_->records_per_segment * sizeof(T));
+            records_ = nullptr;
+        }
+    }
+
+    std::string dir_;
+    JournalHeader* header_;
+    const T* records_;
+    uint64_t segment_index_;
+    uint64_t position_;
+    uint64_t skipped_;
+    bool failed_;
+};
+
+} // namespace ipc
+
+#endif // IPC_JOURNAL_H
@@ -0,0 +1,190 @@
+#ifndef IPC_LAST_VALUE_CACHE_H
+#define IPC_LAST_VALUE_CACHE_H
+
+#include "futex.h"
+#include "ipc/metrics.h"
+#include "ipc/seqlock.h"
+#include "ipc/shared_segment.h"
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <signal.h>
+#include <unistd.h>
+
+namespace ipc {
+
+/**
+ * @brief Keyed conflation table in shared memory: the producer overwrites the
+ *        latest value per key, and each consumer learns which keys changed
+ *        since it last looked.
+ *
+ * @details Unlike a queue, a slow consumer never builds a backlog and never
+ *          holds the producer back. If a key is updated ten times between two
+ *          polls, the consumer reads it once, with the newest value and a
+ *          sequence number from which it can tell that nine updates were
+ *          conflated. Memory is fixed and catching up costs at most one read
+ *          per key, however far behind the consumer is.
+ *
+ *          - Keys are dense indices in [0, Keys). Each value is an
+ *            ipc::Seqlock on its own cache line, so readers never block the
+ *            producer.
+ *          - Each subscriber has a two-level dirty bitmap: one bit per key and
+ *            a summary word with one bit per bitmap word. publish() sets the
+ *            key's bit, then the summary bit if the word was clean, and wakes
+ *            the subscriber only if its summary was empty. A subscriber that
+ *            has not drained an earlier update to the same word costs the
+ *            producer one locked instruction and no wake-up.
+ *          - poll() takes the summary and the dirty words with exchange(0),
+ *            so a key updated while it is being read is reported again on the
+ *            next poll rather than lost.
+ *
+ *          Zero-filled memory is an empty table with no subscribers.
+ *
+ * @tparam Value          Trivially copyable value stored per key.
+ * @tparam Keys           Number of keys, a multiple of 64 and at most 4096.
+ * @tparam MaxSubscribers Number of consumers that can subscribe at once.
+ */
+template <typename Value, std::size_t Keys, std::size_t MaxSubscribers>
+struct LastValueCache {
+    static_assert(Keys != 0 && Keys % 64 == 0 && Keys <= 64 * 64, "Keys must be a multiple of 64, at most 4096");
+
+    static constexpr std::size_t WORDS = Keys / 64;
+    static constexpr int SPIN_ROUNDS = 128;
+
+    struct alignas(64) Cell {
+        Seqlock<Value> value;
+    };
+
+    struct alignas(64) Subscriber {
+        std::atomic<int32_t> pid;        // Owning consumer, 0 if free
+        uint32_t reserved;
+        std::atomic<uint64_t> summary;   // Bit w set while dirty[w] may be non-zero
+        FutexEvent wake;                 // The owner parks here while summary is 0
+        alignas(64) std::atomic<uint64_t> dirty[WORDS]; // One bit per key changed since the last poll
+    };
+
+    Cell cells[Keys];
+    Subscriber subscribers[MaxSubscribers];
+
+    /// Resets a segment for reuse; a freshly truncated one is already empty.
+    void init() {
+        for (std::size_t key = 0; key < Keys; ++key) {
+            cells[key].value.init();
+        }
+        for (std::size_t i = 0; i < MaxSubscribers; ++i) {
+            subscribers[i].pid.store(0, std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    /**
+     * Producer side: stores the newest value of `key` and marks it dirty for
+     * every subscriber.
+     * @return false if `key` is out of range
+     */
+    bool publish(std::size_t key, const Value& value) {
+        if (key >= Keys) {
+            return false;
+        }
+        cells[key].value.store(value);
+
+        const std::size_t word = key / 64;
+        const uint64_t bit = uint64_t(1) << (key % 64);
+        for (std::size_t i = 0; i < MaxSubscribers; ++i) {
+            Subscriber& s = subscribers[i];
+            if (s.pid.load(std::memory_order_relaxed) == 0) {
+                continue;
+            }
+            // Always an RMW: it orders the value store before the subscriber's exchange(0)
+            if (s.dirty[word].fetch_or(bit, std::memory_order_acq_rel) != 0) {
+                continue; // Word already pending, so is its summary bit
+            }
+            if (s.summary.fetch_or(uint64_t(1) << word, std::memory_order_acq_rel) == 0) {
+                s.wake.notify_one(true);
+            }
+        }
+        return true;
+    }
+
+    /// Latest value of `key` and its sequence number (updates so far); false if never published.
+    bool read(std::size_t key, Value& out, uint64_t* sequence = nullptr) const {
+        return key < Keys && cells[key].value.load(out, sequence);
+    }
+
+    /**
+     * Consumer side: claims a free subscriber slot, or one left by a consumer
+     * that died, and marks every key dirty so the first poll() delivers a
+     * full snapshot.
+     * @return nullptr if all slots are taken
+     */
+    Subscriber* subscribe() {
+        int32_t self = static_cast<int32_t>(getpid());
+        for (std::size_t i = 0; i < MaxSubscribers; ++i) {
+            Subscriber& s = subscribers[i];
+            int32_t owner = s.pid.load(std::memory_order_relaxed);
+            bool free = owner == 0 || (kill(owner, 0) == -1 && errno == ESRCH);
+            if (free && s.pid.compare_exchange_strong(owner, self, std::memory_order_acq_rel)) {
+                s.wake.init();
+                for (std::size_t w = 0; w < WORDS; ++w) {
+                    s.dirty[w].store(~uint64_t(0), std::memory_order_relaxed);
+                }
+                s.summary.store(WORDS == 64 ? ~uint64_t(0) : (uint64_t(1) << WORDS) - 1, std::memory_order_release);
+                return &s;
+            }
+        }
+        return nullptr;
+    }
+
+    /// Frees a slot claimed by this process; the producer stops marking it.
+    static void unsubscribe(Subscriber* s) {
+        if (s != nullptr) {
+            s->pid.store(0, std::memory_order_release);
+        }
+    }
+
+    /**
+     * Calls `handle(key, value, sequence)` once for every key that changed
+     * since the previous poll, with its newest value. Never blocks.
+     * @return Number of keys delivered
+     */
+    template <typename Handler>
+    std::size_t poll(Subscriber* s, Handler handle) const {
+        std::size_t delivered = 0;
+        uint64_t summary = s->summary.exchange(0, std::memory_order_acq_rel);
+        while (summary != 0) {
+            std::size_t word = static_cast<std::size_t>(__builtin_ctzll(summary));
+            summary &= summary - 1;
+            uint64_t bits = s->dirty[word].exchange(0, std::memory_order_acq_rel);
+            while (bits != 0) {
+                std::size_t key = word * 64 + static_cast<std::size_t>(__builtin_ctzll(bits));
+                bits &= bits - 1;
+                Value value;
+                uint64_t sequence;
+                if (cells[key].value.load(value, &sequence)) {
+                    handle(key, value, sequence);
+                    ++delivered;
+                }
+            }
+        }
+        return delivered;
+    }
+
+    /// poll() that first spins, then parks on a futex until a key changes; spin rounds go to `spins`.
+    template <typename Handler>
+    std::size_t wait(Subscriber* s, Handler handle, std::atomic<uint64_t>* spins = nullptr) const {
+        int rounds =
+            s->wake.wait_until([s]() { return s->summary.load(std::memory_order_acquire) != 0; }, SPIN_ROUNDS, true);
+        if (spins != nullptr) {
+            metric_add(*spins, static_cast<uint64_t>(rounds));
+        }
+        return poll(s, handle);
+    }
+};
+
+template <typename Value, std::size_t Keys, std::size_t MaxSubscribers>
+constexpr std::size_t LastValueCache<Value, Keys, MaxSubscribers>::WORDS;
+
+} // namespace ipc
+
+#endif // IPC_LAST_VALUE_CACHE_H
@@ -0,0 +1,114 @@
+#ifndef IPC_MESSAGE_H
+#define IPC_MESSAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace ipc {
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "Fixed-layout messages are exchanged in little-endian byte order"
+#endif
+
+/**
+ * @brief First 16 bytes of every message generated from a schema by
+ *        tools/msggen.
+ *
+ * @details A message is its fixed part (this header and the schema's fields,
+ *          laid out at offsets checked at compile time) followed by an
+ *          optional variable-length tail. `fixed_size` is where the tail
+ *          starts. Schemas only ever append fields and bump the version, so a
+ *          reader accepts a newer writer's message: its fields are still at
+ *          the same offsets, and it finds the tail from `fixed_size` rather
+ *          than from its own struct size.
+ */
+struct MessageHeader {
+    uint32_t size;       // Whole message: fixed part plus tail, in bytes
+    uint16_t type;       // Message type from the schema
+    uint16_t version;    // Schema version of the writer
+    uint32_t fixed_size; // Offset of the tail
+    uint32_t reserved;
+};
+
+static_assert(sizeof(MessageHeader) == 16, "MessageHeader is part of every message layout");
+
+/// Upper bound on a message a reader will consider; larger sizes are treated as corrupt.
+constexpr std::size_t MAX_MESSAGE_SIZE = 1 << 20;
+
+/**
+ * Bytes a message of `size` occupies in a slot or a byte stream: rounded up
+ * to 8, so messages sent back to back each start aligned and can be read in
+ * place from the receive buffer.
+ */
+constexpr std::size_t padded_size(std::size_t size) { return (size + 7) / 8 * 8; }
+
+/**
+ * @brief Reads `T` in place from a shared memory slot or a receive buffer.
+ * @return The message, or nullptr if `data` does not start with a complete,
+ *         suitably aligned message of type T at least as new as this reader
+ */
+template <typename T>
+const T* view_message(const void* data, std::size_t len) {
+    static_assert(std::is_trivially_copyable<T>::value && std::is_standard_layout<T>::value,
+                  "Messages are generated by tools/msggen");
+    if (len < sizeof(T) || reinterpret_cast<uintptr_t>(data) % alignof(T) != 0) {
+        return nullptr;
+    }
+    const MessageHeader* header = static_cast<const MessageHeader*>(data);
+    if (header->type != T::TYPE || header->version < T::VERSION || header->fixed_size < sizeof(T) ||
+        header->size < header->fixed_size || header->size > len) {
+        return nullptr;
+    }
+    return static_cast<const T*>(data);
+}
+
+/**
+ * @brief Length of the message at the start of a byte stream, for framing
+ *        messages sent back to back over TCP.
+ * @return The padded_size() of the message, 0 while fewer than
+ *         sizeof(MessageHeader) bytes are buffered, or -1 if the header
+ *         cannot be valid
+ */
+inline long frame_size(const void* data, std::size_t len) {
+    if (len < sizeof(MessageHeader)) {
+        return 0;
+    }
+    MessageHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.size < sizeof(MessageHeader) || header.size > MAX_MESSAGE_SIZE ||
+        header.fixed_size < sizeof(MessageHeader) || header.fixed_size > header.size) {
+        return -1;
+    }
+    return static_cast<long>(padded_size(header.size));
+}
+
+/**
+ * @brief Storage for one message of type T with up to TailCapacity tail
+ *        bytes, placeable in shared memory or sent as-is.
+ *
+ * @details Only the first size() bytes are in use: copy or send that many.
+ */
+template <typename T, std::size_t TailCapacity>
+struct MessageSlot {
+    static constexpr std::size_t CAPACITY = padded_size(sizeof(T) + TailCapacity);
+
+    alignas(8) unsigned char bytes[CAPACITY];
+
+    T* get() { return reinterpret_cast<T*>(bytes); }
+    const T* get() const { return reinterpret_cast<const T*>(bytes); }
+
+    /// padded_size() of the message, bounded by the slot so a corrupt header cannot overrun it.
+    std::size_t size() const {
+        std::size_t size = padded_size(get()->header.size);
+        return size < CAPACITY ? size : CAPACITY;
+    }
+};
+
+template <typename T, std::size_t TailCapacity>
+constexpr std::size_t MessageSlot<T, TailCapacity>::CAPACITY;
+
+} // namespace ipc
+
+#endif // IPC_MESSAGE_H
@@ -0,0 +1,153 @@
+#ifndef IPC_METRICS_H
+#define IPC_METRICS_H
+
+#include "ipc/shared_segment.h"
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <signal.h>
+#include <unistd.h>
+
+namespace ipc {
+
+constexpr uint32_t METRICS_MAGIC = 0x4D455452; // "METR"
+constexpr uint32_t METRICS_VERSION = 1;
+constexpr std::size_t METRICS_PAGE_SIZE = 4096;
+constexpr std::size_t METRICS_SLOTS = METRICS_PAGE_SIZE / 64 - 1;
+
+enum MetricsRole : uint32_t {
+    METRICS_FREE = 0,
+    METRICS_PRODUCER = 1,
+    METRICS_CONSUMER = 2
+};
+
+/**
+ * @brief Bumps a counter that only the calling process writes: a plain load
+ *        and store, no locked instruction. Readers in other processes see a
+ *        consistent (possibly slightly stale) value because the word is
+ *        atomic.
+ */
+inline void metric_add(std::atomic<uint64_t>& counter, uint64_t n = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+inline void metric_set(std::atomic<uint64_t>& gauge, uint64_t value) {
+    gauge.store(value, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Counters of one producer or consumer, alone on a cache line so
+ *        participants never write to the same line.
+ *
+ * `messages` counts messages published (producer) or consumed (consumer);
+ * `lag` is how many slots the consumer was behind at its last read.
+ * `waits` counts blocking waits (condition variable, futex, epoll), `spins`
+ * busy-wait rounds (the spin phase of the Channel, LastValueCache and
+ * JournalReader waits, given this counter), `sleeps` timed sleeps and
+ * `overruns` messages that were overwritten before being read, or publishes
+ * that found the ring full.
+ */
+struct alignas(64) RoleMetrics {
+    std::atomic<int32_t> pid;   // Owner, 0 if free
+    std::atomic<uint32_t> role; // MetricsRole
+    std::atomic<uint64_t> messages;
+    std::atomic<uint64_t> lag;
+    std::atomic<uint64_t> waits;
+    std::atomic<uint64_t> spins;
+    std::atomic<uint64_t> sleeps;
+    std::atomic<uint64_t> overruns;
+};
+
+static_assert(sizeof(RoleMetrics) == 64, "One cache line per participant");
+
+/**
+ * @brief Metrics page appended to a shared segment: one page, at a
+ *        page-aligned offset after the segment's payload, so an external
+ *        reader (tools/ipcstat) finds it at the end of any segment without
+ *        knowing the payload type.
+ *
+ * @details Participants claim a slot once at start-up and afterwards only
+ *          store to their own cache line. Reading the page is plain loads:
+ *          sampling costs the hot path no syscalls, locks or shared writes.
+ */
+struct alignas(64) MetricsPage {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t reserved[13];
+    RoleMetrics slots[METRICS_SLOTS];
+
+    void init() {
+        for (std::size_t i = 0; i < METRICS_SLOTS; ++i) {
+            slots[i].pid.store(0, std::memory_order_relaxed);
+            slots[i].role.store(METRICS_FREE, std::memory_order_relaxed);
+        }
+        version = METRICS_VERSION;
+        slot_count = METRICS_SLOTS;
+        std::atomic_thread_fence(std::memory_order_release);
+        magic = METRICS_MAGIC;
+    }
+
+    bool valid() const {
+        return magic == METRICS_MAGIC && version == METRICS_VERSION && slot_count == METRICS_SLOTS;
+    }
+
+    /**
+     * Claims a free slot, or one whose owner died, for the calling process
+     * and zeroes its counters.
+     * @return nullptr if every slot is taken
+     */
+    RoleMetrics* claim(MetricsRole role) {
+        int32_t self = static_cast<int32_t>(getpid());
+        for (std::size_t i = 0; i < METRICS_SLOTS; ++i) {
+            RoleMetrics& slot = slots[i];
+            int32_t owner = slot.pid.load(std::memory_order_relaxed);
+            bool free = owner == 0 || (kill(owner, 0) == -1 && errno == ESRCH);
+            if (free && slot.pid.compare_exchange_strong(owner, self, std::memory_order_acq_rel)) {
+                slot.messages.store(0, std::memory_order_relaxed);
+                slot.lag.store(0, std::memory_order_relaxed);
+                slot.waits.store(0, std::memory_order_relaxed);
+                slot.spins.store(0, std::memory_order_relaxed);
+                slot.sleeps.store(0, std::memory_order_relaxed);
+                slot.overruns.store(0, std::memory_order_relaxed);
+                slot.role.store(role, std::memory_order_release);
+                return &slot;
+            }
+        }
+        return nullptr;
+    }
+
+    /// Frees a slot claimed by this process.
+    static void release(RoleMetrics* slot) {
+        if (slot != nullptr) {
+            slot->role.store(METRICS_FREE, std::memory_order_relaxed);
+            slot->pid.store(0, std::memory_order_release);
+        }
+    }
+};
+
+static_assert(sizeof(MetricsPage) == METRICS_PAGE_SIZE, "The metrics page is exactly one page");
+static_assert(is_shm_placeable<MetricsPage>::value, "The metrics page is read by other processes");
+
+/// Offset of the metrics page behind a payload of `payload_size` bytes.
+constexpr std::size_t metrics_offset(std::size_t payload_size) {
+    return (payload_size + METRICS_PAGE_SIZE - 1) / METRICS_PAGE_SIZE * METRICS_PAGE_SIZE;
+}
+
+/// Segment size for a payload followed by its metrics page.
+constexpr std::size_t with_metrics(std::size_t payload_size) {
+    return metrics_offset(payload_size) + METRICS_PAGE_SIZE;
+}
+
+/// The metrics page of a segment created with with_metrics(), or nullptr if it is too small.
+inline MetricsPage* metrics_page(const SharedSegment& segment) {
+    if (segment.size() < METRICS_PAGE_SIZE || segment.size() % METRICS_PAGE_SIZE != 0) {
+        return nullptr;
+    }
+    return reinterpret_cast<MetricsPage*>(static_cast<char*>(segment.data()) + segment.size() - METRICS_PAGE_SIZE);
+}
+
+} // namespace ipc
+
+#endif // IPC_METRICS_H
@@ -0,0 +1,276 @@
+#ifndef IPC_NOTIFIER_H
+#define IPC_NOTIFIER_H
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+#ifndef SYS_pidfd_getfd
+#define SYS_pidfd_getfd 438
+#endif
+
+namespace ipc {
+
+/**
+ * @brief Per-consumer wake-up registration that lives in shared memory next
+ *        to the data it guards.
+ *
+ * @details A consumer that wants to wait in its own epoll loop, rather than on
+ *          a process-shared condition variable or futex, publishes its pid and
+ *          the number of an eventfd it owns. The producer copies that eventfd
+ *          into its own process with pidfd_getfd() the first time it needs it.
+ *
+ *          `idle` is the only field touched per message: the producer writes
+ *          to the eventfd only when it flips `idle` from 1 to 0, so a consumer
+ *          that keeps up never costs the producer a syscall.
+ *
+ *          Zero-filled memory is a free slot.
+ */
+struct NotifySlot {
+    std::atomic<int32_t> pid;   // Owning consumer, 0 if free
+    std::atomic<int32_t> fd;    // eventfd number inside the owner process
+    std::atomic<uint32_t> idle; // 1 while the owner is about to block
+    std::atomic<uint32_t> grant;// Bumped on every attach and whenever the owner grants a new producer access
+};
+
+/// Marks `count` slots free; for the creator of the segment, before consumers can attach.
+inline void init_notify_slots(NotifySlot* slots, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        slots[i].pid.store(0, std::memory_order_relaxed);
+        slots[i].fd.store(-1, std::memory_order_relaxed);
+        slots[i].idle.store(0, std::memory_order_relaxed);
+        slots[i].grant.store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Claims a free slot (or one left by a consumer that died) for the
+ *        calling process.
+ * @return The claimed slot, or nullptr if all are taken
+ */
+inline NotifySlot* claim_notify_slot(NotifySlot* slots, std::size_t count) {
+    int32_t self = static_cast<int32_t>(getpid());
+    for (std::size_t i = 0; i < count; ++i) {
+        int32_t owner = slots[i].pid.load(std::memory_order_relaxed);
+        bool free = owner == 0 || (kill(owner, 0) == -1 && errno == ESRCH);
+        if (free && slots[i].pid.compare_exchange_strong(owner, self, std::memory_order_acq_rel)) {
+            slots[i].fd.store(-1, std::memory_order_relaxed);
+            slots[i].idle.store(0, std::memory_order_relaxed);
+            // A new eventfd may reuse the number of the previous owner's: the
+            // bump tells senders that their cached copy is stale
+            slots[i].grant.fetch_add(1, std::memory_order_release);
+            return &slots[i];
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Consumer side: owns the eventfd and its slot registration.
+ *
+ * @details Typical event loop:
+ *
+ *              while (true) {
+ *                  while (has_work()) { consume(); }
+ *                  if (listener.go_idle(has_work)) {
+ *                      epoll_wait(...);  // eventfd is readable once woken
+ *                  }
+ *                  listener.drain();
+ *              }
+ */
+class NotifyListener {
+public:
+    NotifyListener() : slot_(nullptr), fd_(-1) {}
+    ~NotifyListener() { detach(); }
+
+    NotifyListener(const NotifyListener&) = delete;
+    NotifyListener& operator=(const NotifyListener&) = delete;
+
+    /**
+     * Claims a slot and publishes a fresh eventfd in it. `producer_pid`, when
+     * known, is allowed to copy the descriptor even under Yama
+     * ptrace_scope=1, which otherwise only lets ancestors use pidfd_getfd().
+     */
+    bool attach(NotifySlot* slots, std::size_t count, pid_t producer_pid = 0) {
+        detach();
+        fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (fd_ == -1) {
+            perror("eventfd");
+            return false;
+        }
+        slot_ = claim_notify_slot(slots, count);
+        if (slot_ == nullptr) {
+            std::fprintf(stderr, "No free notification slot (%zu in use)\n", count);
+            close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        slot_->fd.store(fd_, std::memory_order_release);
+        if (producer_pid > 0) {
+            allow(producer_pid);
+        }
+        return true;
+    }
+
+    /**
+     * Lets `producer_pid` copy the eventfd. Call again when a restarted
+     * producer takes over the segment: its sender retries a copy that failed
+     * once the grant changes.
+     */
+    void allow(pid_t producer_pid) {
+        prctl(PR_SET_PTRACER, static_cast<unsigned long>(producer_pid), 0, 0, 0);
+        slot_->grant.fetch_add(1, std::memory_order_release);
+    }
+
+    void detach() {
+        if (slot_ != nullptr) {
+            slot_->idle.store(0, std::memory_order_relaxed);
+            slot_->fd.store(-1, std::memory_order_relaxed);
+            slot_->pid.store(0, std::memory_order_release);
+            slot_ = nullptr;
+        }
+        if (fd_ != -1) {
+            close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    /// Register this with EPOLLIN; it becomes readable when the producer wakes us.
+    int fd() const { return fd_; }
+
+    /**
+     * Declares the consumer idle, then re-checks for work so a message
+     * published just before the declaration is not slept through.
+     * @return true if the caller may block until fd() is readable
+     */
+    template <typename HasWork>
+    bool go_idle(HasWork has_work) {
+        slot_->idle.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst); // Pairs with NotifySender::notify()
+        if (has_work()) {
+            slot_->idle.store(0, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    /// Resets the eventfd counter and the idle flag after waking up.
+    void drain() {
+        uint64_t value;
+        while (read(fd_, &value, sizeof(value)) == sizeof(value)) {
+        }
+        slot_->idle.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    NotifySlot* slot_;
+    int fd_;
+};
+
+/**
+ * @brief Producer side: wakes idle consumers through their eventfds.
+ *
+ * @details Copies of the consumers' eventfds are cached per slot and
+ *          refreshed when the slot's owner or grant changes, i.e. when a
+ *          consumer attaches or grants access again (NotifyListener::allow()).
+ *          A consumer whose eventfd cannot be copied (different user, ptrace
+ *          restrictions) is reported once and then skipped until then; its
+ *          idle flag stays set, since it was never woken.
+ *
+ * @tparam MaxSlots Upper bound on the number of slots passed to notify().
+ */
+template <std::size_t MaxSlots>
+class NotifySender {
+public:
+    NotifySender() {
+        for (std::size_t i = 0; i < MaxSlots; ++i) {
+            cached_[i].pid = 0;
+            cached_[i].grant = 0;
+            cached_[i].fd = -1;
+        }
+    }
+
+    ~NotifySender() {
+        for (std::size_t i = 0; i < MaxSlots; ++i) {
+            if (cached_[i].fd != -1) {
+                close(cached_[i].fd);
+            }
+        }
+    }
+
+    NotifySender(const NotifySender&) = delete;
+    NotifySender& operator=(const NotifySender&) = delete;
+
+    /// Call after publishing; costs one fence plus one load per slot unless someone is idle.
+    void notify(NotifySlot* slots, std::size_t count) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (std::size_t i = 0; i < count && i < MaxSlots; ++i) {
+            if (slots[i].idle.load(std::memory_order_relaxed) == 0) {
+                continue;
+            }
+            // Only claim the wake-up once it can be delivered
+            int fd = local_fd(slots[i], cached_[i]);
+            if (fd == -1 || slots[i].idle.exchange(0, std::memory_order_relaxed) == 0) {
+                continue;
+            }
+            uint64_t one = 1;
+            if (write(fd, &one, sizeof(one)) == -1 && errno != EAGAIN) {
+                perror("eventfd write");
+            }
+        }
+    }
+
+private:
+    struct Cached {
+        int32_t pid;    // Owner whose eventfd `fd` is a copy of
+        uint32_t grant; // Slot's grant when the copy was attempted
+        int fd;         // -1 if not copied (yet, or copying failed)
+    };
+
+    static int local_fd(NotifySlot& slot, Cached& cached) {
+        int32_t pid = slot.pid.load(std::memory_order_acquire);
+        uint32_t grant = slot.grant.load(std::memory_order_acquire);
+        if (pid == cached.pid && grant == cached.grant) {
+            return cached.fd;
+        }
+        if (cached.fd != -1) {
+            close(cached.fd);
+        }
+        cached.pid = pid;
+        cached.grant = grant;
+        cached.fd = -1;
+
+        int remote_fd = slot.fd.load(std::memory_order_acquire);
+        if (pid == 0 || remote_fd == -1) {
+            cached.pid = 0; // Not fully registered yet; retry next time
+            return -1;
+        }
+        int pidfd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+        if (pidfd == -1) {
+            perror("pidfd_open");
+            return -1;
+        }
+        cached.fd = static_cast<int>(syscall(SYS_pidfd_getfd, pidfd, remote_fd, 0));
+        if (cached.fd == -1) {
+            perror("pidfd_getfd");
+        }
+        close(pidfd);
+        return cached.fd;
+    }
+
+    Cached cached_[MaxSlots];
+};
+
+} // namespace ipc
+
+#endif // IPC_NOTIFIER_H
@@ -0,0 +1,413 @@
+#ifndef IPC_RUNTIME_CONFIG_H
+#define IPC_RUNTIME_CONFIG_H
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <sys/mman.h>
+#include <vector>
+
+namespace ipc {
+
+/**
+ * @brief Parses a Linux CPU list ("3", "0-3", "1,4-5") as used by taskset
+ *        and /sys/devices/system/cpu/.
+ * @return false if `text` is malformed
+ */
+inline bool parse_cpu_list(const char* text, std::vector<int>& cpus) {
+    cpus.clear();
+    const char* p = text;
+    while (*p != '\0' && *p != '\n') {
+        char* end = nullptr;
+        long first = std::strtol(p, &end, 10);
+        if (end == p || first < 0) {
+            return false;
+        }
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = std::strtol(p + 1, &end, 10);
+            if (end == p + 1 || last < first) {
+                return false;
+            }
+            p = end;
+        }
+        for (long cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+        if (*p == ',') {
+            ++p;
+        } else if (*p != '\0' && *p != '\n') {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline std::string format_cpu_list(const std::vector<int>& cpus) {
+    std::string text;
+    for (std::size_t i = 0; i < cpus.size(); ++i) {
+        std::size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) {
+            ++j;
+        }
+        if (!text.empty()) {
+            text += ',';
+        }
+        text += std::to_string(cpus[i]);
+        if (j > i) {
+            text += '-' + std::to_string(cpus[j]);
+        }
+        i = j;
+    }
+    return text.empty() ? "none" : text;
+}
+
+// First line of a sysfs/procfs file, empty if it cannot be read
+inline std::string read_first_line(const std::string& path) {
+    std::ifstream file(path.c_str());
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+// NUMA node of `cpu` from its nodeN link in sysfs, -1 if unknown
+inline int cpu_numa_node(int cpu) {
+    std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) {
+        return -1;
+    }
+    int node = -1;
+    while (dirent* entry = readdir(dir)) {
+        if (std::strncmp(entry->d_name, "node", 4) == 0 && std::isdigit(static_cast<unsigned char>(entry->d_name[4]))) {
+            node = std::atoi(entry->d_name + 4);
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+}
+
+/**
+ * @brief One line describing the machine: CPU model, online, isolated and
+ *        nohz_full CPUs. Printed by the benchmarks so a result can be tied to
+ *        the topology it was measured on.
+ */
+inline std::string describe_machine() {
+    std::string model;
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 10, "model name") == 0) {
+            std::size_t colon = line.find(':');
+            model = (colon == std::string::npos) ? line : line.substr(colon + 2);
+            break;
+        }
+    }
+    std::string isolated = read_first_line("/sys/devices/system/cpu/isolated");
+    std::string nohz = read_first_line("/sys/devices/system/cpu/nohz_full");
+    return (model.empty() ? std::string("unknown CPU") : model) +
+           ", online " + read_first_line("/sys/devices/system/cpu/online") +
+           ", isolated " + (isolated.empty() ? "none" : isolated) +
+           ", nohz_full " + (nohz.empty() || nohz == "(null)" ? "none" : nohz);
+}
+
+/**
+ * @brief Moves the calling thread off the hot path: SCHED_OTHER, on the online
+ *        CPUs that are not isolated.
+ *
+ * @details For background threads such as the async logger's backend and the
+ *          journal roller. They are started after RuntimeConfig::apply() and
+ *          would otherwise inherit SCHED_FIFO and the role's CPUs, competing
+ *          with the hot thread on its isolated core, or being starved by it.
+ *          If every online CPU is isolated, only the policy is reset.
+ * @return false if the thread could not be moved
+ */
+inline bool apply_housekeeping() {
+    sched_param param = {};
+    int rc = pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+    if (rc != 0) {
+        std::fprintf(stderr, "[housekeeping] SCHED_OTHER: %s\n", std::strerror(rc));
+        return false;
+    }
+
+    std::vector<int> online;
+    std::vector<int> isolated;
+    if (!parse_cpu_list(read_first_line("/sys/devices/system/cpu/online").c_str(), online)) {
+        return false;
+    }
+    parse_cpu_list(read_first_line("/sys/devices/system/cpu/isolated").c_str(), isolated);
+    std::vector<int> shared;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : online) {
+        if (std::find(isolated.begin(), isolated.end(), cpu) == isolated.end()) {
+            CPU_SET(cpu, &set);
+            shared.push_back(cpu);
+        }
+    }
+    if (shared.empty()) {
+        return true;
+    }
+    rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0) {
+        std::fprintf(stderr, "[housekeeping] Cannot move to CPUs %s: %s\n", format_cpu_list(shared).c_str(),
+                     std::strerror(rc));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Placement and scheduling for one role (producer, consumer, server
+ *        worker, ...): which CPUs it may run on, SCHED_FIFO priority and
+ *        whether its memory is locked.
+ *
+ * @details Settings come from the environment and can be overridden on the
+ *          command line:
+ *
+ *              IPC_CPUS=2-3          --cpus=2-3            all roles
+ *              IPC_CPUS_<ROLE>=2     --<role>-cpus=2       one role
+ *              IPC_SCHED_FIFO=50     --fifo=50             SCHED_FIFO priority
+ *              IPC_SCHED_FIFO_<ROLE> --<role>-fifo=50
+ *              IPC_MLOCK=1           --mlock               mlockall()
+ *
+ *          A priority must lie in sched_get_priority_min/max(SCHED_FIFO)
+ *          (1..99 on Linux); 0 keeps SCHED_OTHER. Malformed values in the
+ *          environment or on the command line make parse_args() fail.
+ *
+ *          apply() restricts the whole process to the role's CPUs; threads
+ *          created afterwards inherit that mask and the scheduling policy,
+ *          except housekeeping threads, which call apply_housekeeping().
+ *          apply_thread() narrows the calling thread to a single CPU of the set.
+ *
+ *          Pinning to a CPU that is not in the kernel's isolated set only
+ *          prints a warning: other tasks and interrupts may still preempt it.
+ */
+class RuntimeConfig {
+public:
+    explicit RuntimeConfig(const std::string& role)
+        : role_(role), fifo_priority_(0), lock_memory_(false), env_valid_(true) {
+        std::string upper;
+        for (char c : role) {
+            upper += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+        const char* value;
+        if ((value = env("IPC_CPUS_" + upper)) != nullptr || (value = env("IPC_CPUS")) != nullptr) {
+            env_valid_ = set_cpus(value);
+        }
+        if ((value = env("IPC_SCHED_FIFO_" + upper)) != nullptr || (value = env("IPC_SCHED_FIFO")) != nullptr) {
+            env_valid_ = set_fifo_priority(value) && env_valid_;
+        }
+        if ((value = env("IPC_MLOCK")) != nullptr) {
+            lock_memory_ = std::atoi(value) != 0;
+        }
+    }
+
+    /**
+     * Applies the command-line overrides meant for this role. Unrelated
+     * arguments are ignored; strip_args() removes the runtime ones afterwards.
+     * @return false on a malformed value here or in the environment
+     */
+    bool parse_args(int argc, char** argv) {
+        const std::string role_cpus = "--" + role_ + "-cpus=";
+        const std::string role_fifo = "--" + role_ + "-fifo=";
+        const char* cpus = nullptr;
+        const char* fifo = nullptr;
+        bool role_cpus_seen = false;
+        bool role_fifo_seen = false;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            // A role-specific flag wins over the generic one wherever it appears
+            if (starts_with(arg, role_cpus)) {
+                cpus = argv[i] + role_cpus.size();
+                role_cpus_seen = true;
+            } else if (starts_with(arg, "--cpus=") && !role_cpus_seen) {
+                cpus = argv[i] + 7;
+            } else if (starts_with(arg, role_fifo)) {
+                fifo = argv[i] + role_fifo.size();
+                role_fifo_seen = true;
+            } else if (starts_with(arg, "--fifo=") && !role_fifo_seen) {
+                fifo = argv[i] + 7;
+            } else if (arg == "--mlock") {
+                lock_memory_ = true;
+            }
+        }
+        bool valid = env_valid_;
+        if (fifo != nullptr) {
+            valid = set_fifo_priority(fifo) && valid;
+        }
+        return (cpus == nullptr || set_cpus(cpus)) && valid;
+    }
+
+    /// Removes every runtime flag (for any role) from argv; returns the new argc.
+    static int strip_args(int argc, char** argv) {
+        int kept = 1;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool runtime = arg == "--mlock" || starts_with(arg, "--cpus=") || starts_with(arg, "--fifo=") ||
+                           (starts_with(arg, "--") && (arg.find("-cpus=") != std::string::npos ||
+                                                       arg.find("-fifo=") != std::string::npos));
+            if (!runtime) {
+                argv[kept++] = argv[i];
+            }
+        }
+        argv[kept] = nullptr;
+        return kept;
+    }
+
+    /**
+     * Locks memory, restricts the process to the role's CPUs and switches the
+     * calling thread to SCHED_FIFO, as configured. Call before creating
+     * threads so they inherit the settings.
+     * @return false if any requested setting could not be applied
+     */
+    bool apply() const {
+        if (lock_memory_ && mlockall(MCL_CURRENT | MCL_FUTURE) == -1) {
+            perror("mlockall");
+            return false;
+        }
+        if (!cpus_.empty()) {
+            if (!set_affinity(cpus_)) {
+                return false;
+            }
+            warn_if_not_isolated();
+        }
+        return set_fifo();
+    }
+
+    /**
+     * Pins the calling thread to CPU number `index` (modulo the set size) of
+     * the role and applies its scheduling policy; for worker threads of a
+     * role that share one RuntimeConfig.
+     */
+    bool apply_thread(unsigned index) const {
+        if (!cpus_.empty() && !set_affinity(std::vector<int>(1, cpus_[index % cpus_.size()]))) {
+            return false;
+        }
+        return set_fifo();
+    }
+
+    /// "producer: cpus 2 (node 0), SCHED_FIFO 50, mlock on"
+    std::string describe() const {
+        std::string text = role_ + ": cpus " + format_cpu_list(cpus_);
+        if (!cpus_.empty()) {
+            std::vector<int> nodes;
+            for (int cpu : cpus_) {
+                int node = cpu_numa_node(cpu);
+                if (node >= 0 && std::find(nodes.begin(), nodes.end(), node) == nodes.end()) {
+                    nodes.push_back(node);
+                }
+            }
+            if (!nodes.empty()) {
+                text += " (node " + format_cpu_list(nodes) + ")";
+            }
+        }
+        text += fifo_priority_ > 0 ? ", SCHED_FIFO " + std::to_string(fifo_priority_) : ", SCHED_OTHER";
+        text += lock_memory_ ? ", mlock on" : ", mlock off";
+        return text;
+    }
+
+    const std::string& role() const { return role_; }
+    const std::vector<int>& cpus() const { return cpus_; }
+    int fifo_priority() const { return fifo_priority_; }
+    bool lock_memory() const { return lock_memory_; }
+
+private:
+    static const char* env(const std::string& name) {
+        const char* value = std::getenv(name.c_str());
+        return (value != nullptr && *value != '\0') ? value : nullptr;
+    }
+
+    static bool starts_with(const std::string& text, const std::string& prefix) {
+        return text.compare(0, prefix.size(), prefix) == 0;
+    }
+
+    bool set_cpus(const char* list) {
+        if (!parse_cpu_list(list, cpus_)) {
+            std::fprintf(stderr, "[%s] Invalid CPU list: %s\n", role_.c_str(), list);
+            cpus_.clear();
+            return false;
+        }
+        return true;
+    }
+
+    bool set_fifo_priority(const char* text) {
+        char* end = nullptr;
+        errno = 0;
+        long priority = std::strtol(text, &end, 10);
+        int lowest = sched_get_priority_min(SCHED_FIFO);
+        int highest = sched_get_priority_max(SCHED_FIFO);
+        if (end == text || *end != '\0' || errno != 0 || (priority != 0 && (priority < lowest || priority > highest))) {
+            std::fprintf(stderr, "[%s] Invalid SCHED_FIFO priority: %s (expected %d..%d, or 0 for SCHED_OTHER)\n",
+                         role_.c_str(), text, lowest, highest);
+            fifo_priority_ = 0;
+            return false;
+        }
+        fifo_priority_ = static_cast<int>(priority);
+        return true;
+    }
+
+    bool set_fifo() const {
+        if (fifo_priority_ <= 0) {
+            return true;
+        }
+        sched_param param = {};
+        param.sched_priority = fifo_priority_;
+        int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (rc != 0) {
+            std::fprintf(stderr, "[%s] SCHED_FIFO %d: %s\n", role_.c_str(), fifo_priority_, std::strerror(rc));
+            return false;
+        }
+        return true;
+    }
+
+    bool set_affinity(const std::vector<int>& cpus) const {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus) {
+            CPU_SET(cpu, &set);
+        }
+        int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (rc != 0) {
+            std::fprintf(stderr, "[%s] Cannot pin to CPUs %s: %s\n", role_.c_str(),
+                         format_cpu_list(cpus).c_str(), std::strerror(rc));
+            return false;
+        }
+        return true;
+    }
+
+    void warn_if_not_isolated() const {
+        std::vector<int> isolated;
+        parse_cpu_list(read_first_line("/sys/devices/system/cpu/isolated").c_str(), isolated);
+        std::vector<int> shared;
+        for (int cpu : cpus_) {
+            if (std::find(isolated.begin(), isolated.end(), cpu) == isolated.end()) {
+                shared.push_back(cpu);
+            }
+        }
+        if (!shared.empty()) {
+            std::fprintf(stderr, "[%s] Warning: CPUs %s are not isolated (isolcpus), other tasks may preempt this role\n",
+                         role_.c_str(), format_cpu_list(shared).c_str());
+        }
+    }
+
+    std::string role_;
+    std::vector<int> cpus_;
+    int fifo_priority_;
+    bool lock_memory_;
+    bool env_valid_; // False if an IPC_* variable was malformed
+};
+
+} // namespace ipc
+
+#endif // IPC_RUNTIME_CONFIG_H
@@ -0,0 +1,221 @@
+#ifndef IPC_SEGMENT_HEADER_H
+#define IPC_SEGMENT_HEADER_H
+
+#include "ipc/shared_segment.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace ipc {
+
+constexpr uint32_t SEGMENT_READY = 1;
+constexpr int SEGMENT_CREATE_WAIT_MS = 100; // Longest a live creator takes to write the header
+
+/**
+ * @brief Identifies a shared segment and tells attaching processes whether
+ *        its payload has been initialized. Placed first in the segment's
+ *        shared struct.
+ *
+ * @details `owner`, then `layout_version` and `size`, then `magic` are
+ *          written by the creator before anything else and never change
+ *          afterwards; a zero `magic` means the header is incomplete. `state` becomes
+ *          SEGMENT_READY, with release semantics, only after the payload
+ *          (mutexes, counters, ...) is fully initialized; a consumer that
+ *          maps the segment while the producer is still setting it up waits
+ *          for it instead of using zeroed memory.
+ *
+ *          A producer that restarts finds the segment READY and resumes with
+ *          the existing payload instead of re-initializing it under attached
+ *          consumers. `owner` is the producer currently attached and
+ *          `generation` counts producer attachments (1 after the first start).
+ */
+struct SegmentHeader {
+    uint32_t magic;
+    uint32_t layout_version;
+    uint64_t size;
+    std::atomic<uint32_t> state;
+    std::atomic<int32_t> owner;
+    std::atomic<uint32_t> generation;
+    uint32_t reserved;
+};
+
+static_assert(is_shm_placeable<SegmentHeader>::value, "The segment header is mapped by several processes");
+
+enum SegmentAttach {
+    SEGMENT_ERROR,   // Reported on stderr
+    SEGMENT_CREATED, // Payload must be initialized, then mark_segment_ready()
+    SEGMENT_RESUMED  // Payload is live; consumers may still be attached
+};
+
+inline bool process_alive(int32_t pid) {
+    return pid > 0 && (kill(pid, 0) == 0 || errno != ESRCH);
+}
+
+// Size of the shared memory object `name`, -1 if it does not exist
+inline long long shm_object_size(const char* name) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    struct stat st;
+    long long size = fstat(fd, &st) == 0 ? static_cast<long long>(st.st_size) : -1;
+    close(fd);
+    return size;
+}
+
+// Writes the header of a segment the caller just created or took over; false if another producer got it first
+inline bool init_segment_header(SegmentHeader* header, const char* name, std::size_t size, uint32_t magic,
+                                uint32_t layout_version) {
+    const int32_t self = static_cast<int32_t>(getpid());
+    int32_t owner = header->owner.load(std::memory_order_acquire);
+    if ((owner != 0 && owner != self && process_alive(owner)) ||
+        !header->owner.compare_exchange_strong(owner, self, std::memory_order_acq_rel)) {
+        std::fprintf(stderr, "%s is being created by producer %d\n", name, owner);
+        return false;
+    }
+    header->layout_version = layout_version;
+    header->size = size;
+    header->state.store(0, std::memory_order_relaxed);
+    header->generation.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = magic;
+    return true;
+}
+
+/**
+ * @brief Producer side: creates `name` exclusively, or reattaches to the
+ *        segment a previous producer left behind.
+ *
+ * @details A segment whose creator died before marking it ready is taken
+ *          over and reported as SEGMENT_CREATED, so it is initialized again.
+ *          So is one whose creator died before even sizing it or writing its
+ *          header: an object that stays empty, or without a magic, for
+ *          SEGMENT_CREATE_WAIT_MS. A segment with another magic, layout
+ *          version or size, or whose producer is still running, is refused.
+ */
+inline SegmentAttach create_or_resume_segment(SharedSegment& segment, const char* name, std::size_t size,
+                                              uint32_t magic, uint32_t layout_version) {
+    const int32_t self = static_cast<int32_t>(getpid());
+    if (segment.create(name, size, true)) {
+        if (!init_segment_header(segment.as<SegmentHeader>(), name, size, magic, layout_version)) {
+            segment.reset();
+            return SEGMENT_ERROR;
+        }
+        return SEGMENT_CREATED;
+    }
+    if (errno != EEXIST) {
+        return SEGMENT_ERROR;
+    }
+
+    // Give a creator that is still starting up time to size the object and write its header
+    SegmentHeader* header = nullptr;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SEGMENT_CREATE_WAIT_MS);
+    while (true) {
+        long long existing = shm_object_size(name);
+        if (existing > 0) {
+            if (!segment.open(name, 0)) {
+                return SEGMENT_ERROR;
+            }
+            header = segment.as<SegmentHeader>();
+            if (header == nullptr || header->magic != 0) {
+                break;
+            }
+            segment.reset();
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            // Its creator died between shm_open() and writing the header
+            std::fprintf(stderr, "%s was never initialized; taking it over\n", name);
+            if (!segment.create(name, size) ||
+                !init_segment_header(segment.as<SegmentHeader>(), name, size, magic, layout_version)) {
+                segment.reset();
+                return SEGMENT_ERROR;
+            }
+            return SEGMENT_CREATED;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (header == nullptr || segment.size() != size || header->magic != magic ||
+        header->layout_version != layout_version || header->size != size) {
+        std::fprintf(stderr, "%s was created by a build with a different layout; remove it first\n", name);
+        segment.reset();
+        return SEGMENT_ERROR;
+    }
+    int32_t owner = header->owner.load(std::memory_order_acquire);
+    if (owner != self && process_alive(owner)) {
+        std::fprintf(stderr, "%s is in use by producer %d\n", name, owner);
+        segment.reset();
+        return SEGMENT_ERROR;
+    }
+    if (!header->owner.compare_exchange_strong(owner, self, std::memory_order_acq_rel)) {
+        std::fprintf(stderr, "%s was taken over by producer %d\n", name, owner);
+        segment.reset();
+        return SEGMENT_ERROR;
+    }
+    header->generation.fetch_add(1, std::memory_order_relaxed);
+    return header->state.load(std::memory_order_acquire) == SEGMENT_READY ? SEGMENT_RESUMED : SEGMENT_CREATED;
+}
+
+/// Publishes the payload initialized after SEGMENT_CREATED to waiting consumers.
+inline void mark_segment_ready(SegmentHeader* header) {
+    header->state.store(SEGMENT_READY, std::memory_order_release);
+}
+
+/**
+ * @brief Consumer side: maps `name` once it exists, has its full size and
+ *        has been marked ready, waiting up to `timeout_ms` for the producer.
+ * @return false on timeout or if the segment has another layout
+ */
+inline bool attach_ready_segment(SharedSegment& segment, const char* name, std::size_t size, uint32_t magic,
+                                 uint32_t layout_version, int timeout_ms, bool read_only = false) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    auto retry = [&]() {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return true;
+    };
+
+    // Until ftruncate() has run the object is too small to map; do not report that
+    while (true) {
+        long long existing = shm_object_size(name);
+        if (existing >= 0 && static_cast<std::size_t>(existing) >= size) {
+            break;
+        }
+        if (!retry()) {
+            std::fprintf(stderr, "Timed out waiting for %s to be created\n", name);
+            return false;
+        }
+    }
+    if (!segment.open(name, size, read_only)) {
+        return false;
+    }
+
+    const SegmentHeader* header = segment.as<SegmentHeader>();
+    while (header->state.load(std::memory_order_acquire) != SEGMENT_READY) {
+        if (!retry()) {
+            std::fprintf(stderr, "Timed out waiting for %s to be initialized\n", name);
+            segment.reset();
+            return false;
+        }
+    }
+    if (header->magic != magic || header->layout_version != layout_version || header->size != size) {
+        std::fprintf(stderr, "%s was created by a build with a different layout\n", name);
+        segment.reset();
+        return false;
+    }
+    return true;
+}
+
+} // namespace ipc
+
+#endif // IPC_SEGMENT_HEADER_H
@@ -0,0 +1,120 @@
+#ifndef IPC_SEQLOCK_H
+#define IPC_SEQLOCK_H
+
+#include "futex.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace ipc {
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "64-bit atomics must be lock-free to be shared between processes");
+
+/**
+ * @brief A value guarded by a sequence counter, for data written rarely
+ *        relative to how often it is read, possibly by other processes.
+ *
+ * @details `version` encodes the state of the value:
+ *              0    -> never stored
+ *              odd  -> a writer is storing it
+ *              even -> stable; version / 2 is the number of stores so far
+ *          Writers take the value by CAS'ing the version from even to odd, so
+ *          concurrent writers are serialized. Readers never write: they copy
+ *          the words and retry if the version moved underneath them.
+ *
+ *          The value is kept as relaxed atomic words so a torn read is a
+ *          retry, not a data race. Zero-filled memory is an empty Seqlock.
+ *
+ * @note A writer that dies mid-store leaves the version odd forever and
+ *       readers of that value spin.
+ *
+ * @tparam Value Trivially copyable payload.
+ */
+template <typename Value>
+struct Seqlock {
+    static_assert(std::is_trivially_copyable<Value>::value,
+                  "Value is copied between processes and must be trivially copyable");
+
+    static constexpr std::size_t WORDS = (sizeof(Value) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> version;
+    std::atomic<uint64_t> words[WORDS];
+
+    void init() { version.store(0, std::memory_order_relaxed); }
+
+    /// Publishes a new value; waits while another writer is storing.
+    void store(const Value& value) {
+        uint64_t copy[WORDS] = {};
+        std::memcpy(copy, &value, sizeof(Value));
+
+        // Take the value: version even -> odd
+        uint64_t current = version.load(std::memory_order_relaxed);
+        while (true) {
+            if (current & 1) {
+                cpu_relax();
+                current = version.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (version.compare_exchange_weak(current, current + 1, std::memory_order_acquire,
+                                              std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        // The acquire CAS does not keep the data stores below from becoming
+        // visible before the odd version; this fence does, and pairs with the
+        // acquire fence in load()
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (std::size_t i = 0; i < WORDS; ++i) {
+            words[i].store(copy[i], std::memory_order_relaxed);
+        }
+
+        // Publish: odd -> next even
+        version.store(current + 2, std::memory_order_release);
+    }
+
+    /**
+     * Copies a consistent value without taking any lock.
+     * @param sequence If not null, receives the number of stores the copy reflects
+     * @return false if nothing was stored yet
+     */
+    bool load(Value& out, uint64_t* sequence = nullptr) const {
+        uint64_t copy[WORDS];
+        uint64_t before;
+        while (true) {
+            before = version.load(std::memory_order_acquire);
+            if (before == 0) {
+                return false;
+            }
+            if (before & 1) {
+                cpu_relax();
+                continue;
+            }
+            for (std::size_t i = 0; i < WORDS; ++i) {
+                copy[i] = words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (version.load(std::memory_order_relaxed) == before) {
+                break;
+            }
+        }
+
+        std::memcpy(&out, copy, sizeof(Value));
+        if (sequence != nullptr) {
+            *sequence = before / 2;
+        }
+        return true;
+    }
+
+    /// Number of completed stores.
+    uint64_t sequence() const { return version.load(std::memory_order_acquire) / 2; }
+};
+
+template <typename Value>
+constexpr std::size_t Seqlock<Value>::WORDS;
+
+} // namespace ipc
+
+#endif // IPC_SEQLOCK_H
@@ -0,0 +1,187 @@
+#ifndef IPC_SHARED_SEGMENT_H
+#define IPC_SHARED_SEGMENT_H
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+
+namespace ipc {
+
+/**
+ * @brief True for types that may be placed at the start of a mapping and
+ *        reinterpret_cast'ed there from several processes: standard layout
+ *        (no virtual bases or vtables, so the same bytes mean the same thing
+ *        in every process) and no alignment beyond a cache line.
+ */
+template <typename T>
+struct is_shm_placeable
+    : std::integral_constant<bool, std::is_standard_layout<T>::value && alignof(T) <= 64> {};
+
+/**
+ * @brief RAII mapping of a POSIX shared memory object (or an anonymous
+ *        MAP_SHARED region that survives fork()).
+ *
+ * @details Replaces the shm_open/ftruncate/mmap sequence every example used
+ *          to repeat in main(). The mapping and the descriptor are released
+ *          by the destructor; the name itself stays until unlink() so other
+ *          processes can still attach.
+ *
+ *          Errors are reported with perror() and a false return, the same way
+ *          the examples handled them inline.
+ */
+class SharedSegment {
+public:
+    SharedSegment() : fd_(-1), data_(nullptr), size_(0) {}
+
+    ~SharedSegment() { reset(); }
+
+    SharedSegment(SharedSegment&& other) : fd_(other.fd_), data_(other.data_), size_(other.size_) {
+        other.fd_ = -1;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+
+    SharedSegment& operator=(SharedSegment&& other) {
+        if (this != &other) {
+            reset();
+            fd_ = other.fd_;
+            data_ = other.data_;
+            size_ = other.size_;
+            other.fd_ = -1;
+            other.data_ = nullptr;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    SharedSegment(const SharedSegment&) = delete;
+    SharedSegment& operator=(const SharedSegment&) = delete;
+
+    /**
+     * Creates (or, unless `exclusive`, reuses) the object `name`, sizes it to
+     * `size` bytes and maps it read-write. An exclusive create of an object
+     * that already exists fails quietly with errno EEXIST.
+     */
+    bool create(const char* name, std::size_t size, bool exclusive = false) {
+        reset();
+        int fd = shm_open(name, O_CREAT | O_RDWR | (exclusive ? O_EXCL : 0), 0666);
+        if (fd == -1) {
+            if (!exclusive || errno != EEXIST) {
+                perror("shm_open");
+            }
+            return false;
+        }
+        if (ftruncate(fd, static_cast<off_t>(size)) == -1) {
+            perror("ftruncate");
+            close(fd);
+            return false;
+        }
+        return map(fd, size, PROT_READ | PROT_WRITE);
+    }
+
+    /**
+     * Maps an existing object. Fails if it is smaller than `size`, which
+     * usually means it was created by a build with a different layout.
+     * A `size` of 0 maps the whole object, whatever its size.
+     */
+    bool open(const char* name, std::size_t size, bool read_only = false) {
+        reset();
+        int fd = shm_open(name, read_only ? O_RDONLY : O_RDWR, 0666);
+        if (fd == -1) {
+            perror("shm_open");
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == -1) {
+            perror("fstat");
+            close(fd);
+            return false;
+        }
+        if (static_cast<std::size_t>(st.st_size) < size) {
+            std::fprintf(stderr, "%s is %lld bytes, expected at least %zu\n", name,
+                         static_cast<long long>(st.st_size), size);
+            close(fd);
+            return false;
+        }
+        if (size == 0) {
+            size = static_cast<std::size_t>(st.st_size);
+        }
+        return map(fd, size, read_only ? PROT_READ : (PROT_READ | PROT_WRITE));
+    }
+
+    /// Zero-filled MAP_SHARED memory without a name, shared with children after fork().
+    bool anonymous(std::size_t size) {
+        reset();
+        void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED) {
+            perror("mmap");
+            return false;
+        }
+        data_ = ptr;
+        size_ = size;
+        return true;
+    }
+
+    /// Removes the name; processes that still have it mapped keep their mapping.
+    static bool unlink(const char* name) {
+        if (shm_unlink(name) == -1) {
+            if (errno != ENOENT) {
+                perror("shm_unlink");
+            }
+            return false;
+        }
+        return true;
+    }
+
+    /// The mapping viewed as a `T` placed at its start.
+    template <typename T>
+    T* as() const {
+        static_assert(is_shm_placeable<T>::value,
+                      "Shared memory types must be standard layout and at most cache-line aligned");
+        return (sizeof(T) <= size_) ? static_cast<T*>(data_) : nullptr;
+    }
+
+    void* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool valid() const { return data_ != nullptr; }
+
+    /// Unmaps and closes; the destructor does the same.
+    void reset() {
+        if (data_ != nullptr) {
+            munmap(data_, size_);
+        }
+        if (fd_ != -1) {
+            close(fd_);
+        }
+        fd_ = -1;
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+private:
+    bool map(int fd, std::size_t size, int protection) {
+        void* ptr = mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+        if (ptr == MAP_FAILED) {
+            perror("mmap");
+            close(fd);
+            return false;
+        }
+        fd_ = fd;
+        data_ = ptr;
+        size_ = size;
+        return true;
+    }
+
+    int fd_;
+    void* data_;
+    std::size_t size_;
+};
+
+} // namespace ipc
+
+#endif // IPC_SHARED_SEGMENT_H
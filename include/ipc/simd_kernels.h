@@ -0,0 +1,281 @@
+#ifndef IPC_SIMD_KERNELS_H
+#define IPC_SIMD_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define IPC_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace ipc {
+
+// Payload kernels for messages placed in shared memory: CRC32C for
+// per-message integrity and a streaming copy for large payloads.
+//
+// Every kernel has a portable scalar version and x86 versions compiled with
+// per-function target attributes, so the library stays header-only and needs
+// no -msse4.2/-mavx2 flags. crc32c() and stream_copy() pick the best version
+// for the running CPU once (__builtin_cpu_supports) and call it through a
+// function pointer.
+
+/// Which vector extensions the running CPU has.
+struct SimdSupport {
+    bool sse42;
+    bool avx2;
+    bool avx512;
+};
+
+inline const SimdSupport& simd_support() {
+    static const SimdSupport support = []() {
+        SimdSupport s = {false, false, false};
+#ifdef IPC_SIMD_X86
+        __builtin_cpu_init();
+        s.sse42 = __builtin_cpu_supports("sse4.2");
+        s.avx2 = __builtin_cpu_supports("avx2");
+        s.avx512 = __builtin_cpu_supports("avx512f");
+#endif
+        return s;
+    }();
+    return support;
+}
+
+// ---------------------------------------------------------------------------
+// CRC32C (Castagnoli, reflected polynomial 0x82F63B78), the CRC the SSE4.2
+// crc32 instruction computes. crc32c("123456789") == 0xE3069283.
+// ---------------------------------------------------------------------------
+
+namespace simd_detail {
+
+// Slicing-by-8 tables: table[k][b] is the CRC of byte b followed by k zero bytes
+struct Crc32cTables {
+    uint32_t table[8][256];
+
+    Crc32cTables() {
+        for (uint32_t b = 0; b < 256; ++b) {
+            uint32_t crc = b;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+            }
+            table[0][b] = crc;
+        }
+        for (uint32_t b = 0; b < 256; ++b) {
+            for (int k = 1; k < 8; ++k) {
+                table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xFF];
+            }
+        }
+    }
+};
+
+inline const Crc32cTables& crc32c_tables() {
+    static const Crc32cTables tables;
+    return tables;
+}
+
+} // namespace simd_detail
+
+/// Portable CRC32C, slicing-by-8. `crc` continues a previous call (0 to start).
+inline uint32_t crc32c_scalar(const void* data, std::size_t size, uint32_t crc = 0) {
+    const uint32_t (*t)[256] = simd_detail::crc32c_tables().table;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    for (; size >= 8; size -= 8, p += 8) {
+        uint32_t lo, hi;
+        std::memcpy(&lo, p, 4);
+        std::memcpy(&hi, p + 4, 4);
+        lo ^= crc; // Little-endian byte order, as on every target this repo builds for
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+    }
+    for (; size > 0; --size, ++p) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p) & 0xFF];
+    }
+    return ~crc;
+}
+
+#ifdef IPC_SIMD_X86
+/// CRC32C with the SSE4.2 crc32 instruction, 8 bytes per step. Only call if simd_support().sse42.
+__attribute__((target("sse4.2"))) inline uint32_t crc32c_sse42(const void* data, std::size_t size,
+                                                                uint32_t crc = 0) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+#if defined(__x86_64__)
+    uint64_t crc64 = crc;
+    for (; size >= 8; size -= 8, p += 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = static_cast<uint32_t>(crc64);
+#endif
+    for (; size >= 4; size -= 4, p += 4) {
+        uint32_t word;
+        std::memcpy(&word, p, 4);
+        crc = _mm_crc32_u32(crc, word);
+    }
+    for (; size > 0; --size, ++p) {
+        crc = _mm_crc32_u8(crc, *p);
+    }
+    return ~crc;
+}
+#endif
+
+typedef uint32_t (*Crc32cFunction)(const void*, std::size_t, uint32_t);
+
+/// CRC32C with the fastest kernel the CPU supports.
+inline uint32_t crc32c(const void* data, std::size_t size, uint32_t crc = 0) {
+    static const Crc32cFunction kernel = []() -> Crc32cFunction {
+#ifdef IPC_SIMD_X86
+        if (simd_support().sse42) {
+            return crc32c_sse42;
+        }
+#endif
+        return crc32c_scalar;
+    }();
+    return kernel(data, size, crc);
+}
+
+// ---------------------------------------------------------------------------
+// Streaming copy: non-temporal stores write the destination without reading
+// it into the cache first and without evicting the working set. That wins
+// for payloads larger than the cache, or that the consumer reads much later;
+// a consumer that reads a small message right away is better served by
+// memcpy, which leaves the data in the shared last-level cache.
+// ---------------------------------------------------------------------------
+
+/// stream_copy_threshold() when the last-level cache size is unknown.
+constexpr std::size_t DEFAULT_STREAM_COPY_THRESHOLD = 16 * 1024 * 1024;
+
+/**
+ * @brief Payloads of at least this many bytes are copied with non-temporal
+ *        stores by copy_payload().
+ *
+ * @details Half the last-level cache: copying N bytes touches 2N, so from
+ *          there on the destination cannot stay cached for the consumer and
+ *          memcpy only evicts other data. Below it memcpy is as fast or
+ *          faster (kernel_benchmark on a Xeon VM: 13.1 GB/s against 12.0 for
+ *          AVX-512 stores at 1 MiB; streaming only ahead at 64 MiB) and
+ *          leaves the payload in the LLC for the readers. Set
+ *          IPC_STREAM_COPY_THRESHOLD (bytes) to override it after measuring.
+ */
+inline std::size_t stream_copy_threshold() {
+    static const std::size_t threshold = []() -> std::size_t {
+        const char* text = std::getenv("IPC_STREAM_COPY_THRESHOLD");
+        if (text != nullptr && *text != '\0') {
+            return static_cast<std::size_t>(std::strtoull(text, nullptr, 10));
+        }
+        long llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+        return llc > 0 ? static_cast<std::size_t>(llc) / 2 : DEFAULT_STREAM_COPY_THRESHOLD;
+    }();
+    return threshold;
+}
+
+#ifdef IPC_SIMD_X86
+/// Non-temporal copy with 32-byte AVX2 stores. Only call if simd_support().avx2.
+__attribute__((target("avx2"))) inline void stream_copy_avx2(void* dst, const void* src, std::size_t size) {
+    char* d = static_cast<char*>(dst);
+    const char* s = static_cast<const char*>(src);
+    // Streaming stores need an aligned destination; the source may be unaligned
+    std::size_t head = (32 - (reinterpret_cast<uintptr_t>(d) & 31)) & 31;
+    if (head > size) {
+        head = size;
+    }
+    std::memcpy(d, s, head);
+    d += head;
+    s += head;
+    size -= head;
+    for (; size >= 128; size -= 128, d += 128, s += 128) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 32));
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 64));
+        __m256i e = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 96));
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(d), a);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(d + 32), b);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(d + 64), c);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(d + 96), e);
+    }
+    for (; size >= 32; size -= 32, d += 32, s += 32) {
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(d), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s)));
+    }
+    _mm_sfence(); // Streaming stores are weakly ordered: complete them before the payload is published
+    std::memcpy(d, s, size);
+}
+
+/// Non-temporal copy with 64-byte AVX-512 stores. Only call if simd_support().avx512.
+__attribute__((target("avx512f"))) inline void stream_copy_avx512(void* dst, const void* src, std::size_t size) {
+    char* d = static_cast<char*>(dst);
+    const char* s = static_cast<const char*>(src);
+    std::size_t head = (64 - (reinterpret_cast<uintptr_t>(d) & 63)) & 63;
+    if (head > size) {
+        head = size;
+    }
+    std::memcpy(d, s, head);
+    d += head;
+    s += head;
+    size -= head;
+    for (; size >= 256; size -= 256, d += 256, s += 256) {
+        __m512i a = _mm512_loadu_si512(s);
+        __m512i b = _mm512_loadu_si512(s + 64);
+        __m512i c = _mm512_loadu_si512(s + 128);
+        __m512i e = _mm512_loadu_si512(s + 192);
+        _mm512_stream_si512(reinterpret_cast<__m512i*>(d), a);
+        _mm512_stream_si512(reinterpret_cast<__m512i*>(d + 64), b);
+        _mm512_stream_si512(reinterpret_cast<__m512i*>(d + 128), c);
+        _mm512_stream_si512(reinterpret_cast<__m512i*>(d + 192), e);
+    }
+    for (; size >= 64; size -= 64, d += 64, s += 64) {
+        _mm512_stream_si512(reinterpret_cast<__m512i*>(d), _mm512_loadu_si512(s));
+    }
+    _mm_sfence();
+    std::memcpy(d, s, size);
+}
+#endif
+
+typedef void (*CopyFunction)(void*, const void*, std::size_t);
+
+inline void copy_scalar(void* dst, const void* src, std::size_t size) { std::memcpy(dst, src, size); }
+
+/// Non-temporal copy with the widest stores the CPU supports; memcpy elsewhere.
+inline void stream_copy(void* dst, const void* src, std::size_t size) {
+    static const CopyFunction kernel = []() -> CopyFunction {
+#ifdef IPC_SIMD_X86
+        if (simd_support().avx512) {
+            return stream_copy_avx512;
+        }
+        if (simd_support().avx2) {
+            return stream_copy_avx2;
+        }
+#endif
+        return copy_scalar;
+    }();
+    kernel(dst, src, size);
+}
+
+/// Copies a payload into shared memory: memcpy below stream_copy_threshold(), stream_copy() above.
+inline void copy_payload(void* dst, const void* src, std::size_t size) {
+    if (size < stream_copy_threshold()) {
+        std::memcpy(dst, src, size);
+    } else {
+        stream_copy(dst, src, size);
+    }
+}
+
+/// "crc32c sse4.2, stream copy avx512": the kernels crc32c() and stream_copy() dispatch to.
+inline const char* simd_kernel_names() {
+    const SimdSupport& s = simd_support();
+    if (s.avx512) {
+        return s.sse42 ? "crc32c sse4.2, stream copy avx512" : "crc32c scalar, stream copy avx512";
+    }
+    if (s.avx2) {
+        return s.sse42 ? "crc32c sse4.2, stream copy avx2" : "crc32c scalar, stream copy avx2";
+    }
+    return s.sse42 ? "crc32c sse4.2, stream copy memcpy" : "crc32c scalar, stream copy memcpy";
+}
+
+} // namespace ipc
+
+#endif // IPC_SIMD_KERNELS_H
@@ -0,0 +1,81 @@
+#ifndef IPC_SYNC_H
+#define IPC_SYNC_H
+
+#include <cerrno>
+#include <pthread.h>
+
+namespace ipc {
+
+/**
+ * @brief Initializes a pthread mutex that lives in shared memory so any
+ *        process mapping the segment can lock it.
+ *
+ * @details A `robust` mutex whose owner dies while holding it is handed to
+ *          the next locker with EOWNERDEAD instead of blocking every process
+ *          forever; lock it with lock_shared_mutex(), which recovers it.
+ * @return 0 on success, otherwise the pthread error code
+ */
+inline int init_shared_mutex(pthread_mutex_t* mutex, bool robust = false) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    if (robust) {
+        pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    }
+    int rc = pthread_mutex_init(mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return rc;
+}
+
+/**
+ * @brief Initializes a pthread condition variable that lives in shared memory.
+ * @return 0 on success, otherwise the pthread error code
+ */
+inline int init_shared_cond(pthread_cond_t* cond) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    int rc = pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+    return rc;
+}
+
+/**
+ * @brief Locks a shared mutex. If it is robust and its previous owner died
+ *        holding it, marks it consistent so it stays usable.
+ * @return 0, EOWNERDEAD if the mutex was recovered (the data it guards may be
+ *         half-updated), otherwise the pthread error code
+ */
+inline int lock_shared_mutex(pthread_mutex_t* mutex) {
+    int rc = pthread_mutex_lock(mutex);
+    if (rc == EOWNERDEAD) {
+        pthread_mutex_consistent(mutex);
+    }
+    return rc;
+}
+
+/// pthread_cond_wait() that recovers a robust mutex the same way as lock_shared_mutex().
+inline int wait_shared_cond(pthread_cond_t* cond, pthread_mutex_t* mutex) {
+    int rc = pthread_cond_wait(cond, mutex);
+    if (rc == EOWNERDEAD) {
+        pthread_mutex_consistent(mutex);
+    }
+    return rc;
+}
+
+/// Holds a pthread mutex for the lifetime of the scope.
+class ScopedLock {
+public:
+    explicit ScopedLock(pthread_mutex_t* mutex) : mutex_(mutex) { lock_shared_mutex(mutex_); }
+    ~ScopedLock() { pthread_mutex_unlock(mutex_); }
+
+    ScopedLock(const ScopedLock&) = delete;
+    ScopedLock& operator=(const ScopedLock&) = delete;
+
+private:
+    pthread_mutex_t* mutex_;
+};
+
+} // namespace ipc
+
+#endif // IPC_SYNC_H
@@ -0,0 +1,23 @@
+#ifndef LOG_LEVEL_H
+#define LOG_LEVEL_H
+
+// Numeric log levels, usable in #if
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO  2
+#define LOG_LEVEL_WARN  3
+#define LOG_LEVEL_ERROR 4
+#define LOG_LEVEL_OFF   5
+
+// Build-time threshold: statements below it are compiled out entirely.
+// Set with -DLOG_ACTIVE_LEVEL=LOG_LEVEL_DEBUG (CMake: -DIPC_LOG_LEVEL=DEBUG).
+#ifndef LOG_ACTIVE_LEVEL
+#define LOG_ACTIVE_LEVEL LOG_LEVEL_INFO
+#endif
+
+inline const char* log_level_name(int level) {
+    static const char* const names[] = {"TRACE", "DEBUG", "INFO", "WARN", "ERROR"};
+    return (level >= LOG_LEVEL_TRACE && level <= LOG_LEVEL_ERROR) ? names[level] : "?";
+}
+
+#endif // LOG_LEVEL_H
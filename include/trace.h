@@ -0,0 +1,392 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "tsc_clock.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ * @brief Hot-path tracing spans with TSC timestamps.
+ *
+ * @details `TRACE_SPAN("consumer.wait")` records the TSC when the enclosing
+ *          scope is entered and, when it is left, appends one complete event
+ *          to the calling thread's ring:
+ *
+ *              [begin tsc:u64][end tsc:u64][name:char[32]]
+ *
+ *          All rings live in one TraceSegment. With `IPC_TRACE=/name` in the
+ *          environment the segment is a POSIX shared memory object, so the
+ *          producer, the consumers and the server all append to the same
+ *          segment and share one timeline (the TSC is invariant across cores
+ *          and processes). `tools/trace_dump` converts the segment to the
+ *          Chrome/Perfetto JSON trace format at any time, also while the
+ *          traced processes are still running.
+ *
+ *          Without `IPC_TRACE` tracing is off and a span costs one
+ *          thread-local pointer check. Configuring with `-DIPC_TRACING=OFF`
+ *          removes the spans from the build altogether.
+ *
+ * @note Rings are flight recorders: when one is full the oldest events are
+ *       overwritten. A ring is owned by one thread. When the thread exits
+ *       the ring keeps its events for trace_dump, and is reused once no free
+ *       ring is left, as are the rings of processes that have exited.
+ */
+namespace trace {
+
+constexpr uint64_t SEGMENT_MAGIC = 0x31454341525443ULL; // "CTRACE1"
+constexpr uint32_t SEGMENT_VERSION = 2;
+constexpr std::size_t MAX_RINGS = 32;        // Traced threads across all processes
+constexpr std::size_t RING_EVENTS = 4096;    // Events kept per thread, power of two
+constexpr std::size_t NAME_SIZE = 32;
+
+static_assert((RING_EVENTS & (RING_EVENTS - 1)) == 0, "RING_EVENTS must be a power of two");
+
+struct TraceEvent {
+    uint64_t begin_tsc;
+    uint64_t end_tsc;
+    char name[NAME_SIZE];
+};
+
+static_assert(sizeof(TraceEvent) == 48, "TraceEvent layout is shared between processes");
+
+struct alignas(64) TraceRing {
+    std::atomic<int32_t> owner_pid;   // 0 while the ring is free
+    std::atomic<int32_t> owner_tid;   // 0 once the owning thread has exited, -1 while unclaimed
+    int32_t tid;                      // Thread whose events are in the ring
+    char thread_name[16];
+    alignas(64) std::atomic<uint64_t> head; // Events ever written; only the owner stores
+    TraceEvent events[RING_EVENTS];
+
+    void append(uint64_t begin_tsc, uint64_t end_tsc, const char* name) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        TraceEvent& event = events[h & (RING_EVENTS - 1)];
+        event.begin_tsc = begin_tsc;
+        event.end_tsc = end_tsc;
+        std::memcpy(event.name, name, NAME_SIZE);
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // Called by the owning thread on exit; the events stay readable until the ring is reused
+    void release() { owner_tid.store(0, std::memory_order_release); }
+};
+
+struct TraceSegment {
+    uint64_t magic;
+    uint32_t version;
+    std::atomic<uint32_t> ready;      // Set with release once the header is complete
+    TscCalibration calibration;       // Creator's calibration, used for the whole timeline
+    TraceRing rings[MAX_RINGS];
+
+    void init() {
+        magic = SEGMENT_MAGIC;
+        version = SEGMENT_VERSION;
+        calibration = TscCalibration::get();
+        for (std::size_t i = 0; i < MAX_RINGS; ++i) {
+            rings[i].owner_pid.store(0, std::memory_order_relaxed);
+            rings[i].owner_tid.store(-1, std::memory_order_relaxed);
+            rings[i].head.store(0, std::memory_order_relaxed);
+        }
+        ready.store(1, std::memory_order_release);
+    }
+
+    bool valid() const {
+        return magic == SEGMENT_MAGIC && version == SEGMENT_VERSION &&
+               ready.load(std::memory_order_acquire) == 1;
+    }
+
+    /**
+     * Hands the calling thread a free ring, or else one left behind by an
+     * exited thread or a dead process. Reused rings are claimed by swapping
+     * in the caller's tid, which no other live thread can hold.
+     */
+    TraceRing* claim_ring() {
+        int32_t pid = static_cast<int32_t>(getpid());
+        int32_t tid = static_cast<int32_t>(syscall(SYS_gettid));
+        TraceRing* ring = nullptr;
+        for (std::size_t i = 0; i < MAX_RINGS && ring == nullptr; ++i) {
+            int32_t expected = 0;
+            if (rings[i].owner_pid.compare_exchange_strong(expected, pid)) {
+                ring = &rings[i];
+            }
+        }
+        for (std::size_t i = 0; i < MAX_RINGS && ring == nullptr; ++i) {
+            int32_t owner = rings[i].owner_pid.load(std::memory_order_relaxed);
+            int32_t owner_tid = rings[i].owner_tid.load(std::memory_order_relaxed);
+            bool dead = owner != pid && kill(owner, 0) == -1 && errno == ESRCH;
+            if (owner != 0 && (owner_tid == 0 || dead) &&
+                rings[i].owner_tid.compare_exchange_strong(owner_tid, tid)) {
+                ring = &rings[i];
+                ring->head.store(0, std::memory_order_release);
+                ring->owner_pid.store(pid, std::memory_order_release);
+            }
+        }
+        if (ring != nullptr) {
+            ring->owner_tid.store(tid, std::memory_order_relaxed);
+            ring->tid = tid;
+            std::memset(ring->thread_name, 0, sizeof(ring->thread_name));
+            prctl(PR_GET_NAME, ring->thread_name, 0, 0, 0);
+        }
+        return ring;
+    }
+};
+
+namespace detail {
+// Thread-local hold on a ring: hands it back when the thread exits
+struct RingLease {
+    bool resolved;
+    TraceRing* ring;
+
+    ~RingLease() {
+        if (ring != nullptr) {
+            ring->release();
+        }
+    }
+};
+} // namespace detail
+
+// Maps the named segment, creating and initializing it if it does not exist yet
+inline TraceSegment* open_shared_segment(const char* name) {
+    bool created = true;
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0666);
+    if (fd == -1 && errno == EEXIST) {
+        created = false;
+        fd = shm_open(name, O_RDWR, 0666);
+    }
+    if (fd == -1) {
+        perror("trace: shm_open");
+        return nullptr;
+    }
+    if (created && ftruncate(fd, sizeof(TraceSegment)) == -1) {
+        perror("trace: ftruncate");
+        close(fd);
+        return nullptr;
+    }
+
+    // A concurrent creator may not have sized the object yet
+    struct stat st;
+    for (int attempt = 0; fstat(fd, &st) == 0 && st.st_size < static_cast<off_t>(sizeof(TraceSegment)); ++attempt) {
+        if (attempt == 1000) {
+            std::fprintf(stderr, "trace: %s has the wrong size, remove it with trace_dump --unlink\n", name);
+            close(fd);
+            return nullptr;
+        }
+        usleep(1000);
+    }
+
+    void* ptr = mmap(nullptr, sizeof(TraceSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) {
+        perror("trace: mmap");
+        return nullptr;
+    }
+
+    auto* segment = reinterpret_cast<TraceSegment*>(ptr);
+    if (created) {
+        segment->init();
+    }
+    for (int attempt = 0; !segment->valid(); ++attempt) {
+        if (attempt == 1000) {
+            std::fprintf(stderr, "trace: %s is not a trace segment\n", name);
+            munmap(ptr, sizeof(TraceSegment));
+            return nullptr;
+        }
+        usleep(1000);
+    }
+    return segment;
+}
+
+// Process-private segment for tracing a single process
+inline TraceSegment* open_private_segment() {
+    void* ptr = mmap(nullptr, sizeof(TraceSegment), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) {
+        perror("trace: mmap");
+        return nullptr;
+    }
+    auto* segment = reinterpret_cast<TraceSegment*>(ptr);
+    segment->init();
+    return segment;
+}
+
+inline void write_json_string(FILE* out, const char* text, std::size_t max) {
+    std::fputc('"', out);
+    for (std::size_t i = 0; i < max && text[i] != '\0'; ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c == '"' || c == '\\') {
+            std::fputc('\\', out);
+            std::fputc(c, out);
+        } else if (c < 0x20) {
+            std::fprintf(out, "\\u%04x", c);
+        } else {
+            std::fputc(c, out);
+        }
+    }
+    std::fputc('"', out);
+}
+
+/**
+ * @brief Writes every event in the segment as Chrome trace JSON ("X" events
+ *        plus thread-name metadata). Returns the number of span events.
+ *
+ * @details Events the owner may be overwriting while we copy them are
+ *          skipped: after copying, anything older than the ring's current
+ *          head minus its capacity is discarded.
+ */
+inline uint64_t write_chrome_trace(const TraceSegment& segment, FILE* out) {
+    const TscCalibration& calibration = segment.calibration;
+    uint64_t written = 0;
+    bool first = true;
+
+    std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", out);
+    for (std::size_t r = 0; r < MAX_RINGS; ++r) {
+        const TraceRing& ring = segment.rings[r];
+        int32_t pid = ring.owner_pid.load(std::memory_order_acquire);
+        uint64_t head = ring.head.load(std::memory_order_acquire);
+        if (pid == 0 || head == 0) {
+            continue;
+        }
+
+        std::fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":",
+                     first ? "" : ",\n", pid, ring.tid);
+        write_json_string(out, ring.thread_name, sizeof(ring.thread_name));
+        std::fputs("}}", out);
+        first = false;
+
+        uint64_t start = (head > RING_EVENTS) ? head - RING_EVENTS : 0;
+        for (uint64_t i = start; i < head; ++i) {
+            TraceEvent event = ring.events[i & (RING_EVENTS - 1)];
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t now_head = ring.head.load(std::memory_order_relaxed);
+            if (now_head >= RING_EVENTS && i < now_head - RING_EVENTS + 1) {
+                continue; // Overwritten (or being overwritten) while we read it
+            }
+            event.name[NAME_SIZE - 1] = '\0';
+            double ts_us = static_cast<double>(static_cast<int64_t>(event.begin_tsc - calibration.tsc_base)) *
+                           calibration.ns_per_tick / 1000.0;
+            double dur_us = calibration.to_ns(event.end_tsc - event.begin_tsc) / 1000.0;
+            std::fputs(",\n{\"name\":", out);
+            write_json_string(out, event.name, NAME_SIZE);
+            std::fprintf(out, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d}",
+                         ts_us, dur_us, pid, ring.tid);
+            ++written;
+        }
+    }
+    std::fputs("\n]}\n", out);
+    return written;
+}
+
+/**
+ * @brief Process-wide tracer: decides once whether tracing is on and which
+ *        segment the threads of this process write to.
+ */
+class Tracer {
+public:
+    static Tracer& instance() {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    TraceSegment* segment() const { return segment_; }
+
+    // Traces into a private segment when IPC_TRACE is not set; call before the first span
+    bool enable_private() {
+        if (segment_ == nullptr) {
+            segment_ = open_private_segment();
+        }
+        return segment_ != nullptr;
+    }
+
+private:
+    Tracer() : segment_(nullptr) {
+        const char* name = std::getenv("IPC_TRACE");
+        if (name != nullptr && name[0] == '/') {
+            segment_ = open_shared_segment(name);
+        } else if (name != nullptr && name[0] != '\0') {
+            std::fprintf(stderr, "trace: IPC_TRACE must be a shared memory name such as /ipc_trace\n");
+        }
+    }
+
+    TraceSegment* segment_;
+};
+
+// Resolves the calling thread's ring once; nullptr when tracing is off or all rings are taken
+inline TraceRing* local_ring() {
+    static thread_local detail::RingLease lease = {false, nullptr};
+    if (!lease.resolved) {
+        lease.resolved = true;
+        TraceSegment* segment = Tracer::instance().segment();
+        if (segment != nullptr) {
+            lease.ring = segment->claim_ring();
+        }
+    }
+    return lease.ring;
+}
+
+// Span name padded to the fixed event size, built once per call site
+struct SpanSite {
+    char name[NAME_SIZE];
+
+    explicit SpanSite(const char* text) {
+        std::memset(name, 0, sizeof(name));
+        std::strncpy(name, text, sizeof(name) - 1);
+    }
+};
+
+class Span {
+public:
+    // With `keep`, the span is only recorded if *keep is true when the scope is left
+    explicit Span(const SpanSite& site, const bool* keep = nullptr)
+        : ring_(local_ring()), site_(site), keep_(keep), begin_(0) {
+        if (ring_ != nullptr) {
+            begin_ = read_tsc();
+        }
+    }
+
+    ~Span() {
+        if (ring_ != nullptr && (keep_ == nullptr || *keep_)) {
+            ring_->append(begin_, read_tsc(), site_.name);
+        }
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    TraceRing* ring_;
+    const SpanSite& site_;
+    const bool* keep_;
+    uint64_t begin_;
+};
+
+} // namespace trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef IPC_TRACE_DISABLED
+#define TRACE_SPAN(name) do {} while (0)
+#define TRACE_SPAN_IF(name, keep) do { (void)(keep); } while (0)
+#else
+// Records the enclosing scope as one span named `name` (a string literal)
+#define TRACE_SPAN(name)                                                            \
+    static const trace::SpanSite TRACE_CONCAT(trace_site_, __LINE__)(name);         \
+    trace::Span TRACE_CONCAT(trace_span_, __LINE__)(TRACE_CONCAT(trace_site_, __LINE__))
+
+// Like TRACE_SPAN, but dropped unless the bool `keep` is true when the scope is
+// left: for attempts such as a non-blocking read that are noise when they fail
+#define TRACE_SPAN_IF(name, keep)                                                   \
+    static const trace::SpanSite TRACE_CONCAT(trace_site_, __LINE__)(name);         \
+    trace::Span TRACE_CONCAT(trace_span_, __LINE__)(TRACE_CONCAT(trace_site_, __LINE__), &(keep))
+#endif
+
+#endif // TRACE_H
@@ -0,0 +1,73 @@
+#ifndef TSC_CLOCK_H
+#define TSC_CLOCK_H
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Reads the CPU timestamp counter (steady_clock nanoseconds on other targets)
+inline uint64_t read_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * @brief Converts raw TSC readings to wall-clock time.
+ *
+ * @details The calibration samples the TSC against system_clock once, over a
+ *          short busy window, the first time it is needed. Modern x86 CPUs have
+ *          an invariant TSC shared by all cores, so a reading taken on any core
+ *          (or in any process) converts with the same parameters.
+ */
+struct TscCalibration {
+    uint64_t tsc_base;      // TSC at the calibration point
+    int64_t epoch_ns_base;  // system_clock nanoseconds at the calibration point
+    double ns_per_tick;     // Nanoseconds per TSC tick
+
+    int64_t to_epoch_ns(uint64_t tsc) const {
+        return epoch_ns_base + static_cast<int64_t>(
+            static_cast<double>(static_cast<int64_t>(tsc - tsc_base)) * ns_per_tick);
+    }
+
+    double to_ns(uint64_t ticks) const {
+        return static_cast<double>(ticks) * ns_per_tick;
+    }
+
+    static const TscCalibration& get() {
+        static const TscCalibration calibration = measure();
+        return calibration;
+    }
+
+private:
+    static TscCalibration measure() {
+        using namespace std::chrono;
+        auto wall_start = system_clock::now();
+        auto steady_start = steady_clock::now();
+        uint64_t tsc_start = read_tsc();
+
+        // 10 ms is enough for a relative error well below 0.1%
+        while (steady_clock::now() - steady_start < milliseconds(10)) {
+            std::this_thread::yield();
+        }
+
+        auto steady_end = steady_clock::now();
+        uint64_t tsc_end = read_tsc();
+
+        TscCalibration calibration;
+        calibration.tsc_base = tsc_start;
+        calibration.epoch_ns_base = duration_cast<nanoseconds>(wall_start.time_since_epoch()).count();
+        double elapsed_ns = static_cast<double>(duration_cast<nanoseconds>(steady_end - steady_start).count());
+        calibration.ns_per_tick = (tsc_end > tsc_start) ? elapsed_ns / static_cast<double>(tsc_end - tsc_start) : 1.0;
+        return calibration;
+    }
+};
+
+#endif // TSC_CLOCK_H
@@ -0,0 +1,352 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include "futex.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Lock-free work-stealing deque (Chase-Lev, with the C11 memory
+ *        orderings of Le et al., "Correct and Efficient Work-Stealing for
+ *        Weak Memory Models").
+ *
+ * @details The owning thread pushes and pops at the bottom (LIFO, so the
+ *          data it just produced is still in cache); any other thread steals
+ *          from the top (FIFO, so thieves take the oldest and usually largest
+ *          pieces of work). Only the last element is ever contended, and the
+ *          owner and one thief settle that with a single CAS on `top`.
+ *
+ * @tparam T        Element type; the deque stores `T*`.
+ * @tparam Capacity Number of slots, must be a power of two.
+ */
+template <typename T, std::size_t Capacity>
+class ChaseLevDeque {
+    static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+public:
+    ChaseLevDeque() : top_(0), bottom_(0) {}
+
+    // Owner only. Returns false when the deque is full.
+    bool push(T* item) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        if (b - t >= static_cast<int64_t>(Capacity)) {
+            return false;
+        }
+        slots_[b & (Capacity - 1)].store(item, std::memory_order_relaxed);
+        bottom_.store(b + 1, std::memory_order_release); // Publishes the slot to thieves
+        return true;
+    }
+
+    // Owner only. Takes the most recently pushed element.
+    T* pop() {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T* item = slots_[b & (Capacity - 1)].load(std::memory_order_relaxed);
+        if (t == b) {
+            // Last element: race the thieves for it
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // Any thread. Returns nullptr when empty or when another thread won the race.
+    T* steal() {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) {
+            return nullptr;
+        }
+        T* item = slots_[t & (Capacity - 1)].load(std::memory_order_relaxed);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> top_;    // Next element to steal
+    alignas(64) std::atomic<int64_t> bottom_; // Next free slot, owner side
+    alignas(64) std::atomic<T*> slots_[Capacity];
+};
+
+/**
+ * @brief Fixed-size task executor with per-worker deques and random-victim
+ *        stealing, for fanning work out across cores without a central lock.
+ *
+ * @details A task submitted from a worker goes onto that worker's own deque.
+ *          A task submitted from any other thread goes onto one worker's
+ *          inbox, a lock-free stack that the owner (or a thief) takes over in
+ *          one exchange. An idle worker pops its own deque, drains its inbox,
+ *          then tries every other worker starting at a random one, spins
+ *          briefly, and finally parks on a futex. Submitters only make a
+ *          syscall when some worker is actually parked.
+ *
+ * @note Tasks must not throw. wait_idle() must not be called from inside a
+ *       task. The destructor waits for all submitted tasks to finish.
+ */
+class WorkStealingPool {
+public:
+    static constexpr std::size_t DEQUE_CAPACITY = 8192;  // Tasks per worker before submit runs inline
+    static constexpr int SPIN_ROUNDS = 64;               // Steal attempts before parking
+
+    explicit WorkStealingPool(unsigned threads = 0)
+        : wake_epoch_(0), sleepers_(0), pending_(0), idle_waiters_(0), next_worker_(0), stop_(false) {
+        if (threads == 0) {
+            threads = std::thread::hardware_concurrency();
+        }
+        if (threads == 0) {
+            threads = 1;
+        }
+        for (unsigned i = 0; i < threads; ++i) {
+            workers_.push_back(new Worker(i));
+        }
+        for (unsigned i = 0; i < threads; ++i) {
+            workers_[i]->thread = std::thread(&WorkStealingPool::worker_loop, this, i);
+        }
+    }
+
+    ~WorkStealingPool() {
+        wait_idle();
+        stop_.store(true, std::memory_order_seq_cst);
+        wake_epoch_.fetch_add(1, std::memory_order_seq_cst);
+        futex_wake(&wake_epoch_);
+        // Join everyone before freeing anything: a stopping worker may still scan its peers
+        for (Worker* worker : workers_) {
+            worker->thread.join();
+        }
+        for (Worker* worker : workers_) {
+            delete worker;
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers_.size()); }
+
+    void submit(std::function<void()> fn) {
+        Task* task = new Task;
+        task->fn = std::move(fn);
+        task->next = nullptr;
+        pending_.fetch_add(1, std::memory_order_relaxed);
+
+        Worker* self = current_worker();
+        if (self != nullptr) {
+            if (!self->deque.push(task)) {
+                run(task); // Deque full: the submitter does the work itself
+                return;
+            }
+        } else {
+            Worker* target = workers_[next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size()];
+            Task* head = target->inbox.load(std::memory_order_relaxed);
+            do {
+                task->next = head;
+            } while (!target->inbox.compare_exchange_weak(head, task, std::memory_order_seq_cst,
+                                                          std::memory_order_relaxed));
+        }
+        notify();
+    }
+
+    // Blocks until every task submitted so far (and the tasks they submitted) has run
+    void wait_idle() {
+        idle_waiters_.fetch_add(1, std::memory_order_seq_cst);
+        uint32_t pending;
+        while ((pending = pending_.load(std::memory_order_seq_cst)) != 0) {
+            futex_wait(&pending_, pending);
+        }
+        idle_waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+private:
+    struct Task {
+        std::function<void()> fn;
+        Task* next; // Inbox link
+    };
+
+    struct alignas(64) Worker {
+        ChaseLevDeque<Task, DEQUE_CAPACITY> deque;
+        alignas(64) std::atomic<Task*> inbox;
+        uint64_t rng;
+        std::thread thread;
+
+        explicit Worker(unsigned index) : inbox(nullptr), rng(0x9E3779B97F4A7C15ULL * (index + 1)) {}
+
+        // Plain new only guarantees 16-byte alignment before C++17
+        static void* operator new(std::size_t size) {
+            void* ptr = nullptr;
+            if (posix_memalign(&ptr, alignof(Worker), size) != 0) {
+                throw std::bad_alloc();
+            }
+            return ptr;
+        }
+
+        static void operator delete(void* ptr) { std::free(ptr); }
+    };
+
+    // Worker running on this thread, if it belongs to this pool
+    Worker* current_worker() const {
+        const CurrentWorker& current = current_worker_slot();
+        return (current.pool == this) ? current.worker : nullptr;
+    }
+
+    struct CurrentWorker {
+        const WorkStealingPool* pool;
+        Worker* worker;
+    };
+
+    static CurrentWorker& current_worker_slot() {
+        static thread_local CurrentWorker current = {nullptr, nullptr};
+        return current;
+    }
+
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_relaxed) > 0) {
+            wake_epoch_.fetch_add(1, std::memory_order_release);
+            futex_wake(&wake_epoch_, 1);
+        }
+    }
+
+    void run(Task* task) {
+        task->fn();
+        delete task;
+        if (pending_.fetch_sub(1, std::memory_order_seq_cst) == 1 &&
+            idle_waiters_.load(std::memory_order_seq_cst) > 0) {
+            futex_wake(&pending_);
+        }
+    }
+
+    // Moves a whole inbox into `self`'s deque and returns its oldest task
+    Task* take_inbox(Worker& self, Worker& from) {
+        Task* list = from.inbox.exchange(nullptr, std::memory_order_seq_cst);
+        if (list == nullptr) {
+            return nullptr;
+        }
+        // The inbox is a stack; reverse it so tasks run in submission order
+        Task* ordered = nullptr;
+        while (list != nullptr) {
+            Task* next = list->next;
+            list->next = ordered;
+            ordered = list;
+            list = next;
+        }
+        Task* first = ordered;
+        Task* rest = ordered->next;
+        while (rest != nullptr) {
+            Task* next = rest->next;
+            if (!self.deque.push(rest)) {
+                // No room: hand the remainder back to our own inbox
+                Task* tail = rest;
+                while (tail->next != nullptr) {
+                    tail = tail->next;
+                }
+                Task* head = self.inbox.load(std::memory_order_relaxed);
+                do {
+                    tail->next = head;
+                } while (!self.inbox.compare_exchange_weak(head, rest, std::memory_order_seq_cst,
+                                                           std::memory_order_relaxed));
+                break;
+            }
+            rest = next;
+        }
+        return first;
+    }
+
+    Task* find_task(Worker& self) {
+        Task* task = self.deque.pop();
+        if (task == nullptr) {
+            task = take_inbox(self, self);
+        }
+        if (task != nullptr) {
+            return task;
+        }
+
+        // xorshift64 picks where the scan over the other workers starts
+        self.rng ^= self.rng << 13;
+        self.rng ^= self.rng >> 7;
+        self.rng ^= self.rng << 17;
+        std::size_t count = workers_.size();
+        std::size_t start = static_cast<std::size_t>(self.rng % count);
+        for (std::size_t i = 0; i < count && task == nullptr; ++i) {
+            Worker& victim = *workers_[(start + i) % count];
+            if (&victim == &self) {
+                continue;
+            }
+            task = victim.deque.steal();
+            if (task == nullptr) {
+                task = take_inbox(self, victim);
+            }
+        }
+        if (task != nullptr) {
+            notify(); // Work was queued elsewhere; another sleeper may be useful too
+        }
+        return task;
+    }
+
+    void worker_loop(unsigned index) {
+        Worker& self = *workers_[index];
+        CurrentWorker& current = current_worker_slot();
+        current.pool = this;
+        current.worker = &self;
+
+        while (true) {
+            Task* task = find_task(self);
+            for (int spin = 0; task == nullptr && spin < SPIN_ROUNDS; ++spin) {
+                cpu_relax();
+                task = find_task(self);
+            }
+            if (task != nullptr) {
+                run(task);
+                continue;
+            }
+
+            // Announce we are about to park, then look once more so a task
+            // submitted in between is either seen here or triggers a wake
+            uint32_t epoch = wake_epoch_.load(std::memory_order_acquire);
+            sleepers_.fetch_add(1, std::memory_order_seq_cst);
+            task = find_task(self);
+            if (task == nullptr && !stop_.load(std::memory_order_seq_cst)) {
+                futex_wait(&wake_epoch_, epoch);
+            }
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+
+            if (task != nullptr) {
+                run(task);
+            } else if (stop_.load(std::memory_order_acquire)) {
+                break;
+            }
+        }
+
+        current.pool = nullptr;
+        current.worker = nullptr;
+    }
+
+    std::vector<Worker*> workers_;
+    alignas(64) std::atomic<uint32_t> wake_epoch_;   // Futex word idle workers park on
+    std::atomic<uint32_t> sleepers_;                 // Workers parked or about to park
+    alignas(64) std::atomic<uint32_t> pending_;      // Submitted tasks not finished yet
+    std::atomic<uint32_t> idle_waiters_;             // Threads blocked in wait_idle()
+    alignas(64) std::atomic<uint32_t> next_worker_;  // Round-robin inbox for outside submitters
+    std::atomic<bool> stop_;
+};
+
+#endif // WORK_STEALING_POOL_H
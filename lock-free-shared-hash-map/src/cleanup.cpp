@@ -0,0 +1,11 @@
+#include "shared_defs.h"
+#include <iostream>
+
+int main() {
+    if (!ipc::SharedSegment::unlink(SHM_NAME)) {
+        std::cerr << "Nothing to clean up: " << SHM_NAME << "\n";
+        return 1;
+    }
+    std::cout << "Shared memory cleaned up: " << SHM_NAME << "\n";
+    return 0;
+}
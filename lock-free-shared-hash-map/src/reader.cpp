@@ -0,0 +1,51 @@
+// reader.cpp
+#include "shared_defs.h"
+#include <unistd.h>
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+int main() {
+    // Readers never write to the map, so a read-only mapping is enough
+    ipc::SharedSegment segment;
+    if (!segment.open(SHM_NAME, sizeof(SessionMap), true)) {
+        return 1;
+    }
+
+    const auto* map = segment.as<const SessionMap>();
+    if (!map->valid()) {
+        std::cerr << "[Reader " << getpid() << "] Shared map not initialized or layout mismatch." << std::endl;
+        return 1;
+    }
+    std::cout << "[Reader " << getpid() << "] Attached to map with " << map->size() << " sessions." << std::endl;
+
+    srand(getpid());
+    uint64_t hits = 0, misses = 0, lookups = 0;
+    uint64_t status_counts[4] = {};
+    auto window_start = std::chrono::steady_clock::now();
+
+    while (true) {
+        // Probe a key range slightly larger than the published one to exercise misses
+        uint64_t session = 1 + rand() % (NUM_SESSIONS + NUM_SESSIONS / 8);
+        SessionState state;
+        if (map->find(session, state)) {
+            ++hits;
+            ++status_counts[state.status & 3];
+        } else {
+            ++misses;
+        }
+
+        if ((++lookups & 0xFFFFF) == 0) {
+            auto now = std::chrono::steady_clock::now();
+            double seconds = std::chrono::duration<double>(now - window_start).count();
+            std::cout << "[Reader " << getpid() << "] " << static_cast<uint64_t>(0x100000 / seconds)
+                      << " lookups/s, hits: " << hits << ", misses: " << misses
+                      << ", active: " << status_counts[SESSION_ACTIVE]
+                      << ", idle: " << status_counts[SESSION_IDLE]
+                      << ", closed: " << status_counts[SESSION_CLOSED] << std::endl;
+            window_start = now;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,31 @@
+// shared_defs.h
+#ifndef SHARED_DEFS_H
+#define SHARED_DEFS_H
+
+#include "shm_hash_map.h"
+#include "ipc/shared_segment.h"
+#include <cstdint>
+
+#define SHM_NAME "/shm_session_map"
+#define MAP_CAPACITY 4096   // Buckets, power of two
+#define NUM_SESSIONS 1024   // Sessions published by the writer
+
+enum SessionStatus : uint32_t {
+    SESSION_NEW = 0,
+    SESSION_ACTIVE = 1,
+    SESSION_IDLE = 2,
+    SESSION_CLOSED = 3
+};
+
+struct SessionState {
+    uint32_t status;         // SessionStatus
+    uint32_t owner_pid;      // Process that last updated the session
+    uint64_t updates;        // Incremented on every update of this session
+    uint64_t last_update_ns; // steady_clock timestamp of the last update
+};
+
+typedef ShmHashMap<SessionState, MAP_CAPACITY> SessionMap;
+
+static_assert(ipc::is_shm_placeable<SessionMap>::value, "SessionMap is mapped by several processes");
+
+#endif
@@ -0,0 +1,156 @@
+// shm_hash_map.h
+#ifndef SHM_HASH_MAP_H
+#define SHM_HASH_MAP_H
+
+#include "ipc/seqlock.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Fixed-capacity, open-addressing hash map meant to live in a shared
+ *        memory segment and be used by several processes at once.
+ *
+ * @details The whole map is one flat structure with no pointers, so it can be
+ *          placed at the start of an mmap'd region and reinterpret_cast'ed by
+ *          every process, exactly like `SharedData` in the mutex examples.
+ *
+ *          - Keys are non-zero 64-bit integers (0 marks an empty bucket).
+ *          - Insertion claims a bucket with a CAS on the key, using linear
+ *            probing. Keys are never removed, so probe chains never break.
+ *          - Each bucket's value is an ipc::Seqlock (include/ipc/seqlock.h):
+ *            version 0 means the key is claimed but has no value yet.
+ *            Concurrent updates of the same key are serialized per bucket.
+ *          - Readers never write to shared memory. They copy the value and
+ *            retry if the version changed underneath them.
+ *
+ * @note A process that dies in the middle of an update leaves that one bucket
+ *       odd forever; readers of that key will spin. Size the map so it never
+ *       runs full, since a full map rejects new keys.
+ *
+ * @tparam Value    Trivially copyable payload stored per key.
+ * @tparam Capacity Number of buckets, must be a power of two.
+ */
+template <typename Value, std::size_t Capacity>
+struct ShmHashMap {
+    static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+    static constexpr uint64_t MAGIC = 0x53484d4d41503031ULL; // "SHMMAP01"
+
+    struct alignas(64) Bucket {
+        std::atomic<uint64_t> key;
+        ipc::Seqlock<Value> value;
+    };
+
+    uint64_t magic;
+    uint64_t capacity;
+    alignas(64) std::atomic<uint64_t> count; // Number of claimed buckets
+    Bucket buckets[Capacity];
+
+    /**
+     * Initializes a freshly truncated (zero-filled) segment.
+     * Only the creating process calls this, before anyone else attaches.
+     */
+    void init() {
+        capacity = Capacity;
+        count.store(0, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < Capacity; ++i) {
+            buckets[i].key.store(0, std::memory_order_relaxed);
+            buckets[i].value.init();
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        magic = MAGIC;
+    }
+
+    /// True when the segment was initialized with the same layout.
+    bool valid() const {
+        return magic == MAGIC && capacity == Capacity;
+    }
+
+    /**
+     * Inserts the key if needed and publishes a new value for it.
+     * @return false if the key is 0 or the map is full
+     */
+    bool upsert(uint64_t key, const Value& value) {
+        Bucket* bucket = claim(key);
+        if (bucket == nullptr) {
+            return false;
+        }
+        bucket->value.store(value);
+        return true;
+    }
+
+    /**
+     * Looks up a key without taking any lock.
+     * @param out Receives a consistent copy of the value on success
+     * @return false if the key is absent or has no value published yet
+     */
+    bool find(uint64_t key, Value& out) const {
+        const Bucket* bucket = locate(key);
+        return bucket != nullptr && bucket->value.load(out);
+    }
+
+    /// Number of keys inserted so far.
+    std::size_t size() const {
+        return count.load(std::memory_order_relaxed);
+    }
+
+private:
+    static std::size_t hash(uint64_t key) {
+        // splitmix64 finalizer: cheap and spreads sequential ids well
+        key ^= key >> 30;
+        key *= 0xbf58476d1ce4e5b9ULL;
+        key ^= key >> 27;
+        key *= 0x94d049bb133111ebULL;
+        key ^= key >> 31;
+        return static_cast<std::size_t>(key) & (Capacity - 1);
+    }
+
+    Bucket* claim(uint64_t key) {
+        if (key == 0) {
+            return nullptr;
+        }
+        std::size_t index = hash(key);
+        for (std::size_t probe = 0; probe < Capacity; ++probe) {
+            Bucket& bucket = buckets[index];
+            uint64_t current = bucket.key.load(std::memory_order_acquire);
+            if (current == 0) {
+                if (bucket.key.compare_exchange_strong(current, key, std::memory_order_acq_rel,
+                                                       std::memory_order_acquire)) {
+                    count.fetch_add(1, std::memory_order_relaxed);
+                    return &bucket;
+                }
+                // Lost the race; current now holds the winner's key
+            }
+            if (current == key) {
+                return &bucket;
+            }
+            index = (index + 1) & (Capacity - 1);
+        }
+        return nullptr;
+    }
+
+    const Bucket* locate(uint64_t key) const {
+        if (key == 0) {
+            return nullptr;
+        }
+        std::size_t index = hash(key);
+        for (std::size_t probe = 0; probe < Capacity; ++probe) {
+            const Bucket& bucket = buckets[index];
+            uint64_t current = bucket.key.load(std::memory_order_acquire);
+            if (current == key) {
+                return &bucket;
+            }
+            if (current == 0) {
+                return nullptr;
+            }
+            index = (index + 1) & (Capacity - 1);
+        }
+        return nullptr;
+    }
+};
+
+template <typename Value, std::size_t Capacity>
+constexpr uint64_t ShmHashMap<Value, Capacity>::MAGIC;
+
+#endif
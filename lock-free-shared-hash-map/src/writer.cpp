@@ -0,0 +1,66 @@
+// writer.cpp
+#include "shared_defs.h"
+#include <unistd.h>
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+static uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main(int argc, char* argv[]) {
+    // Pass "attach" to join an existing map as an additional updater
+    bool attach = (argc > 1) && std::strcmp(argv[1], "attach") == 0;
+    srand(time(nullptr) ^ getpid());
+
+    ipc::SharedSegment segment;
+    bool mapped = attach ? segment.open(SHM_NAME, sizeof(SessionMap))
+                         : segment.create(SHM_NAME, sizeof(SessionMap));
+    if (!mapped) {
+        return 1;
+    }
+
+    auto* map = segment.as<SessionMap>();
+    if (attach) {
+        if (!map->valid()) {
+            std::cerr << "[Writer " << getpid() << "] Shared map not initialized or layout mismatch." << std::endl;
+            return 1;
+        }
+        std::cout << "[Writer " << getpid() << "] Attached to existing map with " << map->size() << " sessions." << std::endl;
+    } else {
+        map->init();
+        std::cout << "[Writer " << getpid() << "] Created map with " << MAP_CAPACITY << " buckets." << std::endl;
+    }
+
+    // Publish every session once, then keep updating random ones
+    SessionState state = {};
+    state.owner_pid = getpid();
+    for (uint64_t session = 1; session <= NUM_SESSIONS; ++session) {
+        state.status = SESSION_NEW;
+        state.last_update_ns = now_ns();
+        if (!map->upsert(session, state)) {
+            std::cerr << "[Writer " << getpid() << "] Map full, could not insert session " << session << std::endl;
+        }
+    }
+    std::cout << "[Writer " << getpid() << "] Published " << map->size() << " sessions." << std::endl;
+
+    uint64_t updates = 0;
+    while (true) {
+        uint64_t session = 1 + rand() % NUM_SESSIONS;
+        state.status = 1 + rand() % 3;
+        state.updates = ++updates;
+        state.last_update_ns = now_ns();
+        map->upsert(session, state);
+
+        if (updates % 100000 == 0) {
+            std::cout << "[Writer " << getpid() << "] Updates so far: " << updates << std::endl;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(10));
+    }
+
+    return 0;
+}
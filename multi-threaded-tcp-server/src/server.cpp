@@ -1,3 +1,5 @@
+#include "trace.h"
+#include "ipc/runtime_config.h"
 #include <iostream>
 #include <unistd.h>
 #include <sys/epoll.h>
@@ -25,12 +27,21 @@ int make_socket_non_blocking(int sockfd) {
  * Handles communication with a single client
  * This function runs in a separate thread for each connected client
  * @param client_fd The file descriptor for the client socket
+ * @param runtime CPU set and scheduling policy of the server role
+ * @param worker Index of this worker, selects its CPU within the set
  */
-void handle_client(int client_fd) {
+void handle_client(int client_fd, const ipc::RuntimeConfig* runtime, unsigned worker) {
+    runtime->apply_thread(worker);
     char buf[1024] = {};  // Buffer for reading client data
     ssize_t n;
     while (true) {
-        n = read(client_fd, buf, sizeof(buf) - 1);  // Leave space for null terminator
+        {
+            // Only reads that returned data are recorded, not the empty polls
+            bool got_data = false;
+            TRACE_SPAN_IF("server.read", got_data);
+            n = read(client_fd, buf, sizeof(buf) - 1);  // Leave space for null terminator
+            got_data = n > 0;
+        }
         if (n <= 0) {
             if (n == 0) {
                 std::cout << "🔴 Client disconnected (fd: " << client_fd << ")\n";
@@ -44,11 +55,16 @@ void handle_client(int client_fd) {
                 break;
             }
         } else {
+            TRACE_SPAN("server.request");
             buf[n] = '\0';  // Null terminate the received data
             std::cout << "📨 Received from client: " << buf << std::endl;
             
             // Echo back to client
-            ssize_t bytes_sent = write(client_fd, buf, n);
+            ssize_t bytes_sent;
+            {
+                TRACE_SPAN("server.write");
+                bytes_sent = write(client_fd, buf, n);
+            }
             if (bytes_sent == -1) {
                 if (errno == EAGAIN || errno == EWOULDBLOCK) {
                     // Buffer full, sleep briefly and try again
@@ -67,8 +83,9 @@ void handle_client(int client_fd) {
 /**
  * Main server function that sets up the TCP server and handles incoming connections
  * Uses epoll for efficient I/O multiplexing and creates a new thread for each client
+ * @param runtime CPU set and scheduling policy applied to every worker thread
  */
-void run_server() {
+void run_server(const ipc::RuntimeConfig& runtime) {
     // Create TCP socket
     int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
     if (listen_fd == -1) {
@@ -110,6 +127,7 @@ void run_server() {
     epoll_event events[MAX_EVENTS];
     // Vector to store client threads
     std::vector<std::thread> threads;
+    unsigned workers = 0;
 
     std::cout << "🔌 Server listening on port " << PORT << "\n";
 
@@ -127,7 +145,7 @@ void run_server() {
                     make_socket_non_blocking(client_fd);
                     std::cout << "🟢 New client connected (fd: " << client_fd << ")\n";
                     // Create a new thread to handle this client
-                    threads.push_back(std::thread(handle_client, client_fd));
+                    threads.push_back(std::thread(handle_client, client_fd, &runtime, workers++));
                 }
             }
         }
@@ -145,8 +163,14 @@ void run_server() {
     close(listen_fd);
 }
 
-int main() {
-    run_server();
+int main(int argc, char* argv[]) {
+    // Pin worker threads with IPC_CPUS_SERVER / --server-cpus, one CPU each, round-robin
+    ipc::RuntimeConfig runtime("server");
+    if (!runtime.parse_args(argc, argv) || !runtime.apply()) {
+        return 1;
+    }
+    std::cout << "⚙️  Runtime: " << runtime.describe() << "\n";
+    run_server(runtime);
     return 0;
 }
 
@@ -0,0 +1,128 @@
+// channel.h
+#ifndef BOOST_CHANNEL_H
+#define BOOST_CHANNEL_H
+
+#include <boost/interprocess/sync/interprocess_mutex.hpp>
+#include <boost/interprocess/sync/interprocess_condition.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+/**
+ * @brief Bounded producer/consumer channel placed in shared memory, built on
+ *        `interprocess_mutex` and `interprocess_condition`.
+ *
+ * @details Notifications are batched in both directions to keep the number of
+ *          futex wake-ups well below one per message:
+ *          - The producer only signals `not_empty` when a consumer is actually
+ *            waiting and at least `notify_batch` messages were published since
+ *            the last signal (or on an explicit `flush()`).
+ *          - Consumers drain up to `max` messages per lock acquisition and only
+ *            signal `not_full` when the producer is blocked on a full ring.
+ *
+ * @note Call `flush()` at the end of a burst, otherwise a waiting consumer may
+ *       not see the last (< notify_batch) messages until the next burst.
+ *
+ * @tparam T        Message type, copied by value into the ring.
+ * @tparam Capacity Number of slots in the ring.
+ */
+template <typename T, std::size_t Capacity>
+struct BoostChannel {
+    typedef boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock_type;
+
+    boost::interprocess::interprocess_mutex mutex;
+    boost::interprocess::interprocess_condition not_empty;
+    boost::interprocess::interprocess_condition not_full;
+
+    uint64_t head;              // Messages published
+    uint64_t tail;              // Messages consumed
+    uint32_t consumers_waiting; // Consumers blocked on not_empty
+    uint32_t producer_waiting;  // 1 while the producer is blocked on not_full
+    uint32_t notify_batch;      // Publish this many messages before signalling
+    uint32_t pending;           // Published since the last not_empty signal
+
+    T slots[Capacity];
+
+    /**
+     * Constructs the synchronization primitives in place.
+     * Only the process that created the segment calls this.
+     */
+    void init(uint32_t batch) {
+        new (&mutex) boost::interprocess::interprocess_mutex();
+        new (&not_empty) boost::interprocess::interprocess_condition();
+        new (&not_full) boost::interprocess::interprocess_condition();
+        head = 0;
+        tail = 0;
+        consumers_waiting = 0;
+        producer_waiting = 0;
+        notify_batch = batch == 0 ? 1 : batch;
+        pending = 0;
+    }
+
+    /// Publishes one message, blocking while the ring is full.
+    void send(const T& message) {
+        send(&message, 1);
+    }
+
+    /// Publishes `count` messages under as few lock acquisitions as possible.
+    void send(const T* messages, std::size_t count) {
+        lock_type lock(mutex);
+        for (std::size_t i = 0; i < count; ++i) {
+            while (head - tail == Capacity) {
+                // Never sleep while holding back messages a consumer is waiting for
+                signal_consumers();
+                producer_waiting = 1;
+                not_full.wait(lock);
+            }
+            slots[head % Capacity] = messages[i];
+            ++head;
+            ++pending;
+        }
+        if (pending >= notify_batch) {
+            signal_consumers();
+        }
+    }
+
+    /// Wakes waiting consumers for anything published since the last signal.
+    void flush() {
+        lock_type lock(mutex);
+        signal_consumers();
+    }
+
+    /**
+     * Blocks until at least one message is available and drains up to `max`.
+     * @return Number of messages copied into `out`
+     */
+    std::size_t receive(T* out, std::size_t max) {
+        lock_type lock(mutex);
+        while (head == tail) {
+            ++consumers_waiting;
+            not_empty.wait(lock);
+            --consumers_waiting;
+        }
+
+        std::size_t count = 0;
+        while (count < max && tail != head) {
+            out[count++] = slots[tail % Capacity];
+            ++tail;
+        }
+
+        if (producer_waiting) {
+            producer_waiting = 0;
+            not_full.notify_one();
+        }
+        return count;
+    }
+
+private:
+    // Caller holds the mutex
+    void signal_consumers() {
+        if (pending != 0 && consumers_waiting != 0) {
+            not_empty.notify_all();
+        }
+        pending = 0;
+    }
+};
+
+#endif
@@ -0,0 +1,25 @@
+// channel_consumer.cpp
+#include "channel_defs.h"
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include "async_logger.h"
+#include <unistd.h>
+
+int main() {
+    LOG_INFO("Opening channel shared memory: %s", CHANNEL_SHM_NAME);
+    boost::interprocess::shared_memory_object shm(boost::interprocess::open_only, CHANNEL_SHM_NAME, boost::interprocess::read_write);
+    boost::interprocess::mapped_region region(shm, boost::interprocess::read_write);
+    auto* channel = reinterpret_cast<MessageChannel*>(region.get_address());
+    LOG_INFO("Channel mapped successfully.");
+
+    ChannelMessage batch[CHANNEL_CAPACITY];
+    while (true) {
+        std::size_t count = channel->receive(batch, CHANNEL_CAPACITY);
+        LOG_INFO("[Consumer %d] Received %zu messages, first: %s (seq %llu), last: %s (seq %llu)",
+                 static_cast<int>(getpid()), count,
+                 batch[0].text, static_cast<unsigned long long>(batch[0].sequence),
+                 batch[count - 1].text, static_cast<unsigned long long>(batch[count - 1].sequence));
+    }
+
+    return 0;
+}
@@ -0,0 +1,20 @@
+// channel_defs.h
+#ifndef CHANNEL_DEFS_H
+#define CHANNEL_DEFS_H
+
+#include "channel.h"
+#include <cstdint>
+
+#define CHANNEL_SHM_NAME "my_shared_channel"
+#define CHANNEL_CAPACITY 64
+#define CHANNEL_NOTIFY_BATCH 8
+#define CHANNEL_STRING_SIZE 11  // 10 chars + null terminator
+
+struct ChannelMessage {
+    uint64_t sequence;
+    char text[CHANNEL_STRING_SIZE];
+};
+
+typedef BoostChannel<ChannelMessage, CHANNEL_CAPACITY> MessageChannel;
+
+#endif
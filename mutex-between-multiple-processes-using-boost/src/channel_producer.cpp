@@ -0,0 +1,49 @@
+// channel_producer.cpp
+#include "channel_defs.h"
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include "async_logger.h"
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+
+void random_string(char* str, int length) {
+    static const char charset[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    for (int i = 0; i < length - 1; ++i)
+        str[i] = charset[rand() % (sizeof(charset) - 1)];
+    str[length - 1] = '\0';
+}
+
+int main() {
+    srand(time(nullptr));
+
+    LOG_INFO("Creating channel shared memory...");
+    boost::interprocess::shared_memory_object::remove(CHANNEL_SHM_NAME);
+    boost::interprocess::shared_memory_object shm(boost::interprocess::create_only, CHANNEL_SHM_NAME, boost::interprocess::read_write);
+    shm.truncate(sizeof(MessageChannel));
+
+    boost::interprocess::mapped_region region(shm, boost::interprocess::read_write);
+    auto* channel = reinterpret_cast<MessageChannel*>(region.get_address());
+    channel->init(CHANNEL_NOTIFY_BATCH);
+    LOG_INFO("Channel initialized. Capacity: %d, notify batch: %d",
+             static_cast<int>(CHANNEL_CAPACITY), static_cast<int>(CHANNEL_NOTIFY_BATCH));
+
+    // Publish bursts of messages; consumers are woken once per batch, not per message
+    const int burst = 3 * CHANNEL_NOTIFY_BATCH + 1;
+    ChannelMessage messages[burst];
+    uint64_t sequence = 0;
+
+    while (true) {
+        for (int i = 0; i < burst; ++i) {
+            messages[i].sequence = ++sequence;
+            random_string(messages[i].text, CHANNEL_STRING_SIZE);
+        }
+        channel->send(messages, burst);
+        channel->flush();
+        LOG_INFO("Published burst of %d messages, last sequence: %llu", burst,
+                 static_cast<unsigned long long>(sequence));
+        sleep(1);
+    }
+
+    return 0;
+}
@@ -1,6 +1,7 @@
 #include <boost/interprocess/shared_memory_object.hpp>
 #include <iostream>
 #include "shared_defs.h"
+#include "channel_defs.h"
 
 const char* shm_name = "my_shared_mutex";
 
@@ -12,6 +13,10 @@ int main() {
         std::cout << "❌ Failed to remove shared memory: " << shm_name << "\n";
     }
 
+    if (boost::interprocess::shared_memory_object::remove(CHANNEL_SHM_NAME)) {
+        std::cout << "✅ Shared memory cleaned up: " << CHANNEL_SHM_NAME << "\n";
+    }
+
     return 0;
 }
 
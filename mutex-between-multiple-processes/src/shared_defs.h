@@ -1,8 +1,17 @@
 // shared_defs.h
+#ifndef SHARED_DEFS_H
+#define SHARED_DEFS_H
+
+#include "ipc/shared_segment.h"
 #include <pthread.h>
 
+#define SHM_NAME "/my_shared_mutex"
+
 struct SharedData {
     pthread_mutex_t mutex;
     int counter;
 };
 
+static_assert(ipc::is_shm_placeable<SharedData>::value, "SharedData is mapped by several processes");
+
+#endif
@@ -1,11 +1,10 @@
 #include "common.h"
-#include <fcntl.h>
-#include <sys/mman.h>
-#include <unistd.h>
+#include "ipc/shared_segment.h"
 #include <iostream>
 
 int main() {
-    shm_unlink(SHM_NAME);
+    ipc::SharedSegment::unlink(SHM_NAME);
+    ipc::SharedSegment::unlink(LVC_SHM_NAME);
     std::cout << "Shared memory cleaned up.\n";
     return 0;
 }
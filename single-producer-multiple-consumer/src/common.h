@@ -2,6 +2,15 @@
 #ifndef COMMON_H
 #define COMMON_H
 
+#include "flipflop_messages.h" // Generated from messages.schema
+#include "ipc/last_value_cache.h"
+#include "ipc/message.h"
+#include "ipc/metrics.h"
+#include "ipc/notifier.h"
+#include "ipc/segment_header.h"
+#include "ipc/shared_segment.h"
+#include "ipc/simd_kernels.h"
+#include <cstddef>
 #include <pthread.h>
 
 #define SHM_NAME "/shm_flipflop"
@@ -9,15 +18,93 @@
 #define STRING_SIZE 11  // 10 chars + null terminator
 #define MAX_CONSUMERS 2
 
+// Bump SHM_LAYOUT_VERSION whenever SharedMemory changes, so a restarted
+// producer or a new consumer never attaches to a segment of the old layout
+constexpr uint32_t SHM_MAGIC = 0x464C4950; // "FLIP"
+constexpr uint32_t SHM_LAYOUT_VERSION = 3;
+constexpr int SHM_ATTACH_TIMEOUT_MS = 5000; // How long consumers wait for the producer
+
+// A flipflop::Update with room for a STRING_SIZE text tail
+typedef ipc::MessageSlot<flipflop::Update, STRING_SIZE> UpdateSlot;
+
 struct SharedMemory {
-    char buffer[BUFFER_SIZE][STRING_SIZE];
+    ipc::SegmentHeader header; // Ready once the producer has initialized the rest
+
+    UpdateSlot slot[BUFFER_SIZE];
+    uint32_t checksum[BUFFER_SIZE]; // CRC32C of each slot's message (include/ipc/simd_kernels.h)
     int current_index;   // 0 or 1: flip-flop
     int reader_count;    // Number of consumers that have read the current data
     int active_consumers;// Number of consumers currently running
     int version;         // Version incremented per write
+    int producer_pid;    // Lets epoll-based consumers grant the producer their eventfd
 
     pthread_mutex_t mutex;
     pthread_cond_t cond;
+
+    // Optional eventfd wake-ups for consumers that wait in an epoll loop (gateway.cpp)
+    ipc::NotifySlot notify[MAX_CONSUMERS];
+};
+
+static_assert(ipc::is_shm_placeable<SharedMemory>::value, "SharedMemory is mapped by several processes");
+static_assert(offsetof(SharedMemory, header) == 0, "The segment header must come first");
+
+// SharedMemory followed by the metrics page read by tools/ipcstat
+constexpr std::size_t SHM_SIZE = ipc::with_metrics(sizeof(SharedMemory));
+
+/**
+ * The update in `shm->slot[index]`, read in place, or nullptr if the slot
+ * does not hold a complete update with a matching checksum and a terminated
+ * text. Call with the mutex held.
+ */
+inline const flipflop::Update* verified_update(const SharedMemory* shm, int index) {
+    const UpdateSlot& slot = shm->slot[index];
+    const flipflop::Update* update = ipc::view_message<flipflop::Update>(slot.bytes, sizeof(slot.bytes));
+    if (update == nullptr || ipc::crc32c(slot.bytes, slot.size()) != shm->checksum[index] ||
+        update->text_count() == 0 || update->text()[update->text_count() - 1] != '\0') {
+        return nullptr;
+    }
+    return update;
+}
+
+// Journal mode (producer --journal[=DIR]): every published string is also
+// appended to a file-backed journal that journal_consumer replays by offset
+#define JOURNAL_DIR "flipflop_journal"
+constexpr uint64_t JOURNAL_RECORDS_PER_SEGMENT = 65536; // 2 MiB segment files
+constexpr uint64_t JOURNAL_RETAIN_SEGMENTS = 16;
+
+struct JournalEntry {
+    uint64_t publish_ns;  // system_clock time of the publish
+    int32_t version;      // Flip-flop version the string was published as
+    int32_t producer_pid;
+    char text[STRING_SIZE];
 };
 
+// Conflation mode (lvc_producer / lvc_consumer): the latest quote per
+// instrument instead of a stream, so slow consumers skip stale updates
+#define LVC_SHM_NAME "/shm_lvc"
+#define LVC_INSTRUMENTS 1024
+#define LVC_MAX_CONSUMERS 8
+constexpr uint32_t LVC_MAGIC = 0x4C564331; // "LVC1"
+constexpr uint32_t LVC_LAYOUT_VERSION = 1;
+
+struct Quote {
+    int64_t bid;          // Prices in ticks
+    int64_t ask;
+    uint32_t bid_size;
+    uint32_t ask_size;
+    uint64_t publish_ns;  // steady_clock time of the update, comparable across processes
+};
+
+typedef ipc::LastValueCache<Quote, LVC_INSTRUMENTS, LVC_MAX_CONSUMERS> QuoteCache;
+
+struct LvcSegment {
+    ipc::SegmentHeader header;
+    QuoteCache quotes;
+};
+
+static_assert(ipc::is_shm_placeable<LvcSegment>::value, "LvcSegment is mapped by several processes");
+static_assert(offsetof(LvcSegment, header) == 0, "The segment header must come first");
+
+constexpr std::size_t LVC_SHM_SIZE = ipc::with_metrics(sizeof(LvcSegment));
+
 #endif
\ No newline at end of file
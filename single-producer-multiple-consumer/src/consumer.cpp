@@ -1,45 +1,79 @@
 // consumer.cpp
 #include "common.h"
-#include <fcntl.h>
-#include <sys/mman.h>
+#include "async_logger.h"
+#include "trace.h"
+#include "ipc/metrics.h"
+#include "ipc/runtime_config.h"
+#include "ipc/segment_header.h"
+#include "ipc/shared_segment.h"
+#include "ipc/sync.h"
 #include <unistd.h>
 #include <iostream>
 #include <thread>
 #include <chrono>
 
-int main() {
-    int shm_fd = shm_open(SHM_NAME, O_RDWR, 0666);
-    if (shm_fd == -1) {
-        std::cerr << "[Consumer] Failed to open shared memory" << std::endl;
+int main(int argc, char* argv[]) {
+    ipc::RuntimeConfig runtime("consumer");
+    if (!runtime.parse_args(argc, argv) || !runtime.apply()) {
         return 1;
     }
 
-    SharedMemory* shm = (SharedMemory*) mmap(nullptr, sizeof(SharedMemory), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
-    if (shm == MAP_FAILED) {
-        std::cerr << "[Consumer] Failed to map shared memory" << std::endl;
+    ipc::SharedSegment segment;
+    if (!ipc::attach_ready_segment(segment, SHM_NAME, SHM_SIZE, SHM_MAGIC, SHM_LAYOUT_VERSION,
+                                   SHM_ATTACH_TIMEOUT_MS)) {
+        std::cerr << "[Consumer] Failed to open shared memory" << std::endl;
+        return 1;
+    }
+    SharedMemory* shm = segment.as<SharedMemory>();
+    ipc::RoleMetrics* metrics = ipc::metrics_page(segment)->claim(ipc::METRICS_CONSUMER);
+    if (metrics == nullptr) {
+        std::cerr << "[Consumer] No free metrics slot" << std::endl;
         return 1;
     }
 
-    std::cout << "[Consumer " << getpid() << "] Attached to shared memory." << std::endl;
+    const int pid = getpid();
+    LOG_INFO("[Consumer %d] Attached to shared memory. Runtime: %s", pid, runtime.describe().c_str());
 
     int last_version = -1;
 
     while (true) {
-        pthread_mutex_lock(&shm->mutex);
-        std::cout << "[Consumer " << getpid() << "] Waiting for new version. Last seen: " << last_version << ", Current: " << shm->version << std::endl;
+        {
+            TRACE_SPAN("consumer.wait");
+            ipc::lock_shared_mutex(&shm->mutex);
+            LOG_DEBUG("[Consumer %d] Waiting for new version. Last seen: %d, Current: %d", pid, last_version, shm->version);
 
-        while (shm->version == last_version) {
-            pthread_cond_wait(&shm->cond, &shm->mutex);
+            while (shm->version == last_version) {
+                ipc::metric_add(metrics->waits);
+                ipc::wait_shared_cond(&shm->cond, &shm->mutex);
+            }
         }
 
-        int index = shm->current_index;
-        std::cout << "[Consumer " << getpid() << "] Read: " << shm->buffer[index] << " (ver: " << shm->version << ")" << std::endl;
-        last_version = shm->version;
-        ++shm->reader_count;
-        std::cout << "[Consumer " << getpid() << "] Updated reader count to " << shm->reader_count << std::endl;
+        {
+            // Still holding the mutex taken in the wait span
+            TRACE_SPAN("consumer.read");
+            int index = shm->current_index;
+            const flipflop::Update* update = verified_update(shm, index);
+            if (update != nullptr) {
+                LOG_INFO("[Consumer %d] Read: %s (ver: %d)", pid, update->text(), update->version);
+            } else {
+                LOG_WARN("[Consumer %d] Invalid update in buffer %d (ver: %d)", pid, index, shm->version);
+            }
+            // Versions published since our last read, other than this one, were never
+            // seen; the first read has nothing to lag behind
+            int behind = (last_version == -1) ? 0 : shm->version - last_version;
+            ipc::metric_set(metrics->lag, behind);
+            if (behind > 1) {
+                ipc::metric_add(metrics->overruns, behind - 1);
+            }
+            ipc::metric_add(metrics->messages);
+            last_version = shm->version;
+            ++shm->reader_count;
+            LOG_DEBUG("[Consumer %d] Updated reader count to %d", pid, shm->reader_count);
 
-        pthread_mutex_unlock(&shm->mutex);
+            pthread_mutex_unlock(&shm->mutex);
+        }
 
+        ipc::metric_add(metrics->sleeps);
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
 
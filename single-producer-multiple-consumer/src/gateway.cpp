@@ -0,0 +1,240 @@
+// gateway.cpp
+//
+// A consumer that also serves TCP clients, from a single thread: one epoll
+// loop waits on the listening socket, the client sockets and an eventfd that
+// the producer signals when a new version is published. Every version read
+// from shared memory is forwarded to all connected clients as one line, or
+// with --wire as the flipflop::Update message itself, byte for byte as it
+// sits in the slot (see wire_client.cpp).
+//
+//   gateway [port] [--wire]   (default 9091)
+#include "common.h"
+#include "async_logger.h"
+#include "trace.h"
+#include "ipc/metrics.h"
+#include "ipc/notifier.h"
+#include "ipc/runtime_config.h"
+#include "ipc/segment_header.h"
+#include "ipc/shared_segment.h"
+#include "ipc/sync.h"
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+constexpr int GATEWAY_PORT = 9091;
+constexpr int MAX_EVENTS = 16;
+// Upper bound on an idle wait. A restarted producer may not be allowed to copy
+// our eventfd until we grant it access, so re-check the segment periodically.
+constexpr int IDLE_TIMEOUT_MS = 100;
+
+static int make_socket_non_blocking(int sockfd) {
+    int flags = fcntl(sockfd, F_GETFL, 0);
+    return fcntl(sockfd, F_SETFL, flags | O_NONBLOCK);
+}
+
+static int open_listener(int port) {
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd == -1) {
+        perror("socket");
+        return -1;
+    }
+    int opt = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1 ||
+        listen(listen_fd, SOMAXCONN) == -1) {
+        perror("bind/listen");
+        close(listen_fd);
+        return -1;
+    }
+    make_socket_non_blocking(listen_fd);
+    return listen_fd;
+}
+
+int main(int argc, char* argv[]) {
+    ipc::RuntimeConfig runtime("gateway");
+    if (!runtime.parse_args(argc, argv) || !runtime.apply()) {
+        return 1;
+    }
+    argc = ipc::RuntimeConfig::strip_args(argc, argv);
+    int port = GATEWAY_PORT;
+    bool wire = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--wire") == 0) {
+            wire = true;
+        } else {
+            port = std::atoi(argv[i]);
+        }
+    }
+
+    ipc::SharedSegment segment;
+    if (!ipc::attach_ready_segment(segment, SHM_NAME, SHM_SIZE, SHM_MAGIC, SHM_LAYOUT_VERSION,
+                                   SHM_ATTACH_TIMEOUT_MS)) {
+        std::cerr << "[Gateway] Failed to open shared memory" << std::endl;
+        return 1;
+    }
+    SharedMemory* shm = segment.as<SharedMemory>();
+    ipc::RoleMetrics* metrics = ipc::metrics_page(segment)->claim(ipc::METRICS_CONSUMER);
+    if (metrics == nullptr) {
+        std::cerr << "[Gateway] No free metrics slot" << std::endl;
+        return 1;
+    }
+
+    ipc::NotifyListener listener;
+    int granted_pid = shm->producer_pid;
+    if (!listener.attach(shm->notify, MAX_CONSUMERS, granted_pid)) {
+        return 1;
+    }
+
+    int listen_fd = open_listener(port);
+    if (listen_fd == -1) {
+        return 1;
+    }
+
+    int epoll_fd = epoll_create1(0);
+    if (epoll_fd == -1) {
+        perror("epoll_create1");
+        return 1;
+    }
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.fd = listen_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+    ev.data.fd = listener.fd();
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listener.fd(), &ev);
+
+    const int pid = getpid();
+    LOG_INFO("[Gateway %d] Attached to shared memory, serving %s on port %d. Runtime: %s", pid,
+             wire ? "Update messages" : "lines", port, runtime.describe().c_str());
+
+    std::vector<int> clients;
+    int last_version = -1;
+    // What is sent for the current version: a text line, or a copy of the slot's message
+    UpdateSlot frame;
+    char line[STRING_SIZE + 1];
+    const char* out = wire ? reinterpret_cast<const char*>(frame.bytes) : line;
+    std::size_t out_size = 0;
+
+    // Reads the current version if this consumer has not seen it yet
+    auto read_next = [&]() {
+        TRACE_SPAN("gateway.read");
+        ipc::lock_shared_mutex(&shm->mutex);
+        if (shm->producer_pid != granted_pid) {
+            // The producer was restarted and resumed the segment
+            granted_pid = shm->producer_pid;
+            listener.allow(granted_pid);
+            LOG_INFO("[Gateway %d] Producer %d took over the segment.", pid, granted_pid);
+        }
+        bool fresh = shm->version != last_version;
+        if (fresh) {
+            // The first read has nothing to lag behind
+            int behind = (last_version == -1) ? 0 : shm->version - last_version;
+            ipc::metric_set(metrics->lag, behind);
+            if (behind > 1) {
+                ipc::metric_add(metrics->overruns, behind - 1);
+            }
+            ipc::metric_add(metrics->messages);
+            int index = shm->current_index;
+            const flipflop::Update* update = verified_update(shm, index);
+            out_size = 0;
+            if (update == nullptr) {
+                LOG_WARN("[Gateway %d] Invalid update in buffer %d (ver: %d)", pid, index, shm->version);
+            } else if (wire) {
+                out_size = shm->slot[index].size();
+                std::memcpy(frame.bytes, shm->slot[index].bytes, out_size);
+            } else {
+                out_size = snprintf(line, sizeof(line), "%s\n", update->text());
+            }
+            last_version = shm->version;
+            ++shm->reader_count;
+        }
+        pthread_mutex_unlock(&shm->mutex);
+        return fresh;
+    };
+    auto has_work = [&]() {
+        ipc::lock_shared_mutex(&shm->mutex);
+        bool fresh = shm->version != last_version;
+        pthread_mutex_unlock(&shm->mutex);
+        return fresh;
+    };
+
+    epoll_event events[MAX_EVENTS];
+    while (true) {
+        while (read_next()) {
+            LOG_DEBUG("[Gateway %d] Forwarding version %d to %zu clients", pid, last_version, clients.size());
+            if (out_size == 0) {
+                continue;
+            }
+            for (std::size_t i = 0; i < clients.size();) {
+                int client_fd = clients[i];
+                // Slow clients miss lines rather than stall the loop
+                ssize_t sent = send(client_fd, out, out_size, MSG_NOSIGNAL);
+                if (sent == -1 && errno != EAGAIN) {
+                    perror("send");
+                }
+                if (wire && sent > 0 && static_cast<std::size_t>(sent) < out_size) {
+                    // A partial message would shift every later one: drop the client instead
+                    LOG_WARN("[Gateway %d] Client fd %d cannot keep up, disconnecting", pid, client_fd);
+                    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client_fd, nullptr);
+                    close(client_fd);
+                    clients.erase(clients.begin() + i);
+                    continue;
+                }
+                ++i;
+            }
+        }
+
+        // Block only after telling the producer; otherwise just poll the sockets
+        bool idle = listener.go_idle(has_work);
+        if (idle) {
+            ipc::metric_add(metrics->waits);
+        }
+        int nfds = epoll_wait(epoll_fd, events, MAX_EVENTS, idle ? IDLE_TIMEOUT_MS : 0);
+        if (idle) {
+            listener.drain();
+        }
+
+        for (int i = 0; i < nfds; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == listener.fd()) {
+                continue; // Drained above; the read loop picks up the new version
+            }
+            if (fd == listen_fd) {
+                int client_fd = accept(listen_fd, nullptr, nullptr);
+                if (client_fd != -1) {
+                    make_socket_non_blocking(client_fd);
+                    ev.data.fd = client_fd;
+                    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client_fd, &ev);
+                    clients.push_back(client_fd);
+                    LOG_INFO("[Gateway %d] Client connected (fd: %d)", pid, client_fd);
+                }
+                continue;
+            }
+
+            // Clients only listen; input is discarded and EOF closes the connection
+            char discard[256];
+            ssize_t n = read(fd, discard, sizeof(discard));
+            if (n == 0 || (n == -1 && errno != EAGAIN)) {
+                epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+                close(fd);
+                clients.erase(std::find(clients.begin(), clients.end(), fd));
+                LOG_INFO("[Gateway %d] Client disconnected (fd: %d)", pid, fd);
+            }
+        }
+    }
+
+    return 0;
+}
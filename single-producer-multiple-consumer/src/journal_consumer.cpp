@@ -0,0 +1,64 @@
+// journal_consumer.cpp
+//
+// Reads the producer's journal (producer --journal) by offset instead of the
+// two-slot flip-flop, so it never misses a string while it is down: started
+// late or restarted, it replays from the requested offset at memory speed and
+// then follows the producer live. It does not count towards MAX_CONSUMERS.
+//
+//   journal_consumer [dir] [offset|earliest|latest]   (defaults: flipflop_journal, earliest)
+#include "common.h"
+#include "async_logger.h"
+#include "ipc/journal.h"
+#include "ipc/runtime_config.h"
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[]) {
+    ipc::RuntimeConfig runtime("consumer");
+    if (!runtime.parse_args(argc, argv) || !runtime.apply()) {
+        return 1;
+    }
+    argc = ipc::RuntimeConfig::strip_args(argc, argv);
+    std::string dir = (argc > 1) ? argv[1] : JOURNAL_DIR;
+    const char* from = (argc > 2) ? argv[2] : "earliest";
+
+    ipc::JournalReader<JournalEntry> journal;
+    if (!journal.open(dir)) {
+        std::cerr << "[Journal consumer] Failed to open journal " << dir << std::endl;
+        return 1;
+    }
+    if (std::strcmp(from, "latest") == 0) {
+        journal.seek(journal.head());
+    } else if (std::strcmp(from, "earliest") != 0) {
+        journal.seek(std::strtoull(from, nullptr, 10));
+    }
+
+    const int pid = getpid();
+    LOG_INFO("[Journal consumer %d] Reading %s from offset %llu (on disk: %llu..%llu).", pid, dir.c_str(),
+             static_cast<unsigned long long>(journal.position()),
+             static_cast<unsigned long long>(journal.first()),
+             static_cast<unsigned long long>(journal.head()));
+
+    JournalEntry entry;
+    uint64_t reported_skips = 0;
+    while (true) {
+        if (!journal.read(entry)) {
+            LOG_ERROR("[Journal consumer %d] Stopped at offset %llu: the journal cannot be read.", pid,
+                      static_cast<unsigned long long>(journal.position()));
+            return 1;
+        }
+        if (journal.skipped() != reported_skips) {
+            LOG_WARN("[Journal consumer %d] %llu entries were rolled away before they could be read.", pid,
+                     static_cast<unsigned long long>(journal.skipped() - reported_skips));
+            reported_skips = journal.skipped();
+        }
+        LOG_INFO("[Journal consumer %d] Offset %llu: %s (producer %d, ver: %d)", pid,
+                 static_cast<unsigned long long>(journal.position() - 1), entry.text, entry.producer_pid,
+                 entry.version);
+    }
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+// lvc_consumer.cpp
+//
+// Conflation mode consumer: subscribes to the last-value table written by
+// lvc_producer and receives only the newest quote of each instrument that
+// changed since its previous poll. The optional per-update work simulates a
+// slow consumer; the slower it is, the more updates are conflated, while the
+// producer and the other consumers are unaffected.
+//
+//   lvc_consumer [work us per update]   (default 0)
+#include "common.h"
+#include "async_logger.h"
+#include "trace.h"
+#include "ipc/last_value_cache.h"
+#include "ipc/metrics.h"
+#include "ipc/runtime_config.h"
+#include "ipc/segment_header.h"
+#include "ipc/shared_segment.h"
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+static uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main(int argc, char* argv[]) {
+    ipc::RuntimeConfig runtime("consumer");
+    if (!runtime.parse_args(argc, argv) || !runtime.apply()) {
+        return 1;
+    }
+    argc = ipc::RuntimeConfig::strip_args(argc, argv);
+    const auto work = std::chrono::microseconds((argc > 1) ? std::atoi(argv[1]) : 0);
+
+    ipc::SharedSegment segment;
+    if (!ipc::attach_ready_segment(segment, LVC_SHM_NAME, LVC_SHM_SIZE, LVC_MAGIC, LVC_LAYOUT_VERSION,
+                                   SHM_ATTACH_TIMEOUT_MS)) {
+        std::cerr << "[LVC consumer] Failed to open shared memory" << std::endl;
+        return 1;
+    }
+    QuoteCache& quotes = segment.as<LvcSegment>()->quotes;
+    QuoteCache::Subscriber* subscriber = quotes.subscribe();
+    if (subscriber == nullptr) {
+        std::cerr << "[LVC consumer] All " << LVC_MAX_CONSUMERS << " subscriber slots are taken" << std::endl;
+        return 1;
+    }
+    ipc::RoleMetrics* metrics = ipc::metrics_page(segment)->claim(ipc::METRICS_CONSUMER);
+    if (metrics == nullptr) {
+        std::cerr << "[LVC consumer] No free metrics slot" << std::endl;
+        return 1;
+    }
+
+    const int pid = getpid();
+    LOG_INFO("[LVC consumer %d] Subscribed, %lld us of work per update. Runtime: %s", pid,
+             static_cast<long long>(work.count()), runtime.describe().c_str());
+
+    // Sequence of the last update seen per instrument: gaps are conflated updates
+    std::vector<uint64_t> last_sequence(LVC_INSTRUMENTS, 0);
+    uint64_t received = 0, conflated = 0, max_age_ns = 0;
+    auto window_start = std::chrono::steady_clock::now();
+
+    while (true) {
+        std::size_t keys;
+        {
+            TRACE_SPAN("lvc_consumer.poll");
+            ipc::metric_add(metrics->waits);
+            keys = quotes.wait(subscriber, [&](std::size_t key, const Quote& quote, uint64_t sequence) {
+                if (last_sequence[key] != 0 && sequence > last_sequence[key] + 1) {
+                    conflated += sequence - last_sequence[key] - 1;
+                    ipc::metric_add(metrics->overruns, sequence - last_sequence[key] - 1);
+                }
+                last_sequence[key] = sequence;
+                max_age_ns = std::max(max_age_ns, now_ns() - quote.publish_ns);
+                LOG_DEBUG("[LVC consumer %d] Instrument %zu: %lld/%lld (update %llu)", pid, key,
+                          static_cast<long long>(quote.bid), static_cast<long long>(quote.ask),
+                          static_cast<unsigned long long>(sequence));
+
+                if (work.count() > 0) {
+                    auto until = std::chrono::steady_clock::now() + work;
+                    while (std::chrono::steady_clock::now() < until) {
+                    }
+                }
+            }, &metrics->spins);
+        }
+        received += keys;
+        ipc::metric_add(metrics->messages, keys);
+        ipc::metric_set(metrics->lag, keys);
+
+        auto now = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(now - window_start).count();
+        if (seconds >= 1.0) {
+            LOG_INFO("[LVC consumer %d] %llu quotes/s, %llu updates conflated, max age %llu us", pid,
+                     static_cast<unsigned long long>(received / seconds),
+                     static_cast<unsigned long long>(conflated),
+                     static_cast<unsigned long long>(max_age_ns / 1000));
+            received = 0;
+            conflated = 0;
+            max_age_ns = 0;
+            window_start = now;
+        }
+    }
+
+    return 0;
+}
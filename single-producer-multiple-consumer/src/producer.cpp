@@ -1,12 +1,22 @@
 // producer.cpp
 #include "common.h"
-#include <fcntl.h>
-#include <sys/mman.h>
+#include "async_logger.h"
+#include "trace.h"
+#include "ipc/journal.h"
+#include "ipc/metrics.h"
+#include "ipc/runtime_config.h"
+#include "ipc/segment_header.h"
+#include "ipc/shared_segment.h"
+#include "ipc/simd_kernels.h"
+#include "ipc/sync.h"
 #include <unistd.h>
 #include <iostream>
+#include <cerrno>
 #include <cstdlib>
 #include <ctime>
 #include <cstring>
+#include <chrono>
+#include <string>
 #include <thread>
 
 void random_string(char *str, int length) {
@@ -16,77 +26,155 @@ void random_string(char *str, int length) {
     str[length - 1] = '\0';
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     srand(time(nullptr));
 
-    std::cout << "[Producer] Starting up and creating shared memory." << std::endl;
-    int shm_fd = shm_open(SHM_NAME, O_CREAT | O_RDWR, 0666);
-    if (shm_fd == -1) {
-        std::cerr << "[Producer] Error: Failed to create shared memory." << std::endl;
+    // CPU pinning, SCHED_FIFO and mlockall from IPC_* variables or --cpus/--fifo/--mlock
+    ipc::RuntimeConfig runtime("producer");
+    if (!runtime.parse_args(argc, argv) || !runtime.apply()) {
         return 1;
     }
+    LOG_INFO("[Producer] Runtime: %s", runtime.describe().c_str());
 
-    ftruncate(shm_fd, sizeof(SharedMemory));
-    SharedMemory* shm = (SharedMemory*) mmap(nullptr, sizeof(SharedMemory), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
-    if (shm == MAP_FAILED) {
-        std::cerr << "[Producer] Error: Failed to map shared memory." << std::endl;
+    // --journal[=DIR] (or IPC_JOURNAL=DIR) also appends every string to a replayable journal
+    std::string journal_dir = std::getenv("IPC_JOURNAL") ? std::getenv("IPC_JOURNAL") : "";
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--journal") == 0) {
+            journal_dir = JOURNAL_DIR;
+        } else if (std::strncmp(argv[i], "--journal=", 10) == 0) {
+            journal_dir = argv[i] + 10;
+        }
+    }
+    ipc::JournalWriter<JournalEntry> journal;
+    if (!journal_dir.empty()) {
+        if (!journal.open(journal_dir, JOURNAL_RECORDS_PER_SEGMENT, JOURNAL_RETAIN_SEGMENTS)) {
+            std::cerr << "[Producer] Error: Failed to open journal " << journal_dir << std::endl;
+            return 1;
+        }
+        LOG_INFO("[Producer] Journaling to %s, resuming at offset %llu.", journal_dir.c_str(),
+                 static_cast<unsigned long long>(journal.head()));
+    }
+    JournalEntry entry = {};
+    entry.producer_pid = getpid();
+
+    LOG_INFO("[Producer] Starting up and attaching to shared memory.");
+    auto attach_start = std::chrono::steady_clock::now();
+    ipc::SharedSegment segment;
+    ipc::SegmentAttach attach =
+        ipc::create_or_resume_segment(segment, SHM_NAME, SHM_SIZE, SHM_MAGIC, SHM_LAYOUT_VERSION);
+    if (attach == ipc::SEGMENT_ERROR) {
+        std::cerr << "[Producer] Error: Failed to create or resume shared memory." << std::endl;
         return 1;
     }
+    SharedMemory* shm = segment.as<SharedMemory>();
+    ipc::MetricsPage* metrics_page = ipc::metrics_page(segment);
 
-    // Initialize only once
-    pthread_mutexattr_t mattr;
-    pthread_mutexattr_init(&mattr);
-    pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED);
-    pthread_mutex_init(&shm->mutex, &mattr);
+    if (attach == ipc::SEGMENT_CREATED) {
+        // Initialize only once per segment; consumers wait until it is marked ready
+        ipc::init_shared_mutex(&shm->mutex, true);
+        ipc::init_shared_cond(&shm->cond);
 
-    pthread_condattr_t cattr;
-    pthread_condattr_init(&cattr);
-    pthread_condattr_setpshared(&cattr, PTHREAD_PROCESS_SHARED);
-    pthread_cond_init(&shm->cond, &cattr);
+        shm->current_index = 0;
+        shm->reader_count = 0;
+        shm->version = 0;
+        shm->active_consumers = MAX_CONSUMERS;
+        shm->producer_pid = getpid();
+        ipc::init_notify_slots(shm->notify, MAX_CONSUMERS);
+        metrics_page->init();
+        ipc::mark_segment_ready(&shm->header);
+    } else {
+        // A previous producer left a live segment: keep its counters and the attached consumers.
+        // Its mutex is robust, so dying while holding it did not leave it locked.
+        if (ipc::lock_shared_mutex(&shm->mutex) == EOWNERDEAD) {
+            LOG_WARN("[Producer] Recovered the mutex from the previous producer.");
+        }
+        shm->producer_pid = getpid();
+        pthread_mutex_unlock(&shm->mutex);
+    }
+    ipc::RoleMetrics* metrics = metrics_page->claim(ipc::METRICS_PRODUCER);
+    if (metrics == nullptr) {
+        std::cerr << "[Producer] No free metrics slot" << std::endl;
+        return 1;
+    }
 
-    shm->current_index = 0;
-    shm->reader_count = 0;
-    shm->version = 0;
-    shm->active_consumers = MAX_CONSUMERS;
+    // Wakes consumers that wait on an eventfd instead of the condition variable
+    ipc::NotifySender<MAX_CONSUMERS> notifier;
 
-    std::cout << "[Producer] Initialized shared memory and synchronization primitives." << std::endl;
+    long long attach_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - attach_start).count();
+    if (attach == ipc::SEGMENT_CREATED) {
+        LOG_INFO("[Producer] Initialized shared memory and synchronization primitives.");
+    } else {
+        LOG_INFO("[Producer] Resumed shared memory at version %d (generation %u) in %lld us.", shm->version,
+                 shm->header.generation.load(), attach_us);
+    }
 
+    // The next update, built before taking the lock, so the critical section is a copy and a checksum
+    UpdateSlot next = {};
+    flipflop::Update* update = next.get();
+    update->init(STRING_SIZE);
+    update->producer_pid = getpid();
     while (true) {
-        pthread_mutex_lock(&shm->mutex);
-
-        std::cout << "[Producer] Locked mutex. Reader count: " << shm->reader_count
-                  << ", Active consumers: " << shm->active_consumers
-                  << ", Current index: " << shm->current_index
-                  << ", Version: " << shm->version << std::endl;
-
-        // Wait for all consumers to read
-        if (shm->reader_count >= shm->active_consumers) {
-            shm->current_index = 1 - shm->current_index;
-            shm->reader_count = 0;
-            std::cout << "[Producer] All consumers read. Flipping buffer index to " << shm->current_index << std::endl;
-        }
+        random_string(update->text(), STRING_SIZE);
+        update->publish_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        {
+            TRACE_SPAN("producer.publish");
+            ipc::lock_shared_mutex(&shm->mutex);
 
-        // Write random string
-        int index = shm->current_index;
-        random_string(shm->buffer[index], STRING_SIZE);
-        ++shm->version;
-        std::cout << "[Producer] Wrote: " << shm->buffer[index] << " to buffer index: " << index << " (version: " << shm->version << ")" << std::endl;
+            LOG_DEBUG("[Producer] Locked mutex. Reader count: %d, Active consumers: %d, Current index: %d, Version: %d",
+                      shm->reader_count, shm->active_consumers, shm->current_index, shm->version);
 
-        pthread_cond_broadcast(&shm->cond);
-        std::cout << "[Producer] Broadcasted condition to consumers." << std::endl;
-        pthread_mutex_unlock(&shm->mutex);
-        std::cout << "[Producer] Unlocked mutex after write." << std::endl;
+            // Wait for all consumers to read
+            if (shm->reader_count >= shm->active_consumers) {
+                shm->current_index = 1 - shm->current_index;
+                shm->reader_count = 0;
+                LOG_DEBUG("[Producer] All consumers read. Flipping buffer index to %d", shm->current_index);
+            }
+
+            // Write the update
+            int index = shm->current_index;
+            update->version = ++shm->version;
+            ipc::copy_payload(shm->slot[index].bytes, next.bytes, next.size());
+            shm->checksum[index] = ipc::crc32c(next.bytes, next.size());
+            ipc::metric_add(metrics->messages);
+            LOG_INFO("[Producer] Wrote: %s to buffer index: %d (version: %d)", update->text(), index, shm->version);
+            if (!journal_dir.empty()) {
+                entry.version = shm->version;
+                std::memcpy(entry.text, update->text(), STRING_SIZE);
+            }
+
+            pthread_cond_broadcast(&shm->cond);
+            LOG_DEBUG("[Producer] Broadcasted condition to consumers.");
+            pthread_mutex_unlock(&shm->mutex);
+            LOG_DEBUG("[Producer] Unlocked mutex after write.");
+
+            // No syscall unless a gateway has declared itself idle
+            notifier.notify(shm->notify, MAX_CONSUMERS);
+
+            if (!journal_dir.empty()) {
+                entry.publish_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+                if (!journal.append(entry)) {
+                    LOG_ERROR("[Producer] Journal segment could not be mapped; version %d is not journaled.",
+                              entry.version);
+                }
+            }
+        }
 
         // If consumers have not read, wait; else write again
+        TRACE_SPAN("producer.wait_readers");
         while (true) {
-            pthread_mutex_lock(&shm->mutex);
-            std::cout << "[Producer] Checking if consumers read... Reader count: " << shm->reader_count << ", Expected: " << shm->active_consumers << std::endl;
+            ipc::lock_shared_mutex(&shm->mutex);
+            LOG_TRACE("[Producer] Checking if consumers read... Reader count: %d, Expected: %d",
+                      shm->reader_count, shm->active_consumers);
             if (shm->reader_count >= shm->active_consumers) {
-                std::cout << "[Producer] All consumers have read the buffer. Proceeding to next write." << std::endl;
+                LOG_DEBUG("[Producer] All consumers have read the buffer. Proceeding to next write.");
                 pthread_mutex_unlock(&shm->mutex);
                 break;
             }
             pthread_mutex_unlock(&shm->mutex);
+            ipc::metric_add(metrics->sleeps);
             std::this_thread::sleep_for(std::chrono::milliseconds(5)); // prevent tight loop
         }
     }
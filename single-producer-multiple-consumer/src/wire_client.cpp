@@ -0,0 +1,90 @@
+// wire_client.cpp
+//
+// Client of `gateway --wire`: receives flipflop::Update messages sent back to
+// back and reads their fields in place from the receive buffer, with no
+// parsing or copying (include/ipc/message.h).
+//
+//   wire_client [server ip] [port]   (default 127.0.0.1 9091)
+#include "common.h"
+#include "async_logger.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+constexpr const char* DEFAULT_SERVER_IP = "127.0.0.1";
+constexpr int DEFAULT_PORT = 9091;
+// Holds the largest message frame_size() accepts, so a valid frame always fits
+constexpr std::size_t RECEIVE_BUFFER_SIZE = ipc::MAX_MESSAGE_SIZE;
+static_assert(ipc::padded_size(ipc::MAX_MESSAGE_SIZE) <= RECEIVE_BUFFER_SIZE, "A whole message must fit the buffer");
+
+int main(int argc, char* argv[]) {
+    const char* server_ip = (argc > 1) ? argv[1] : DEFAULT_SERVER_IP;
+    int port = (argc > 2) ? std::atoi(argv[2]) : DEFAULT_PORT;
+
+    int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+    if (sockfd == -1) {
+        perror("socket");
+        return 1;
+    }
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, server_ip, &addr.sin_addr) <= 0) {
+        std::cerr << "Invalid IP address: " << server_ip << std::endl;
+        return 1;
+    }
+    if (connect(sockfd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) {
+        perror("connect");
+        return 1;
+    }
+    LOG_INFO("[Wire client] Connected to %s:%d", server_ip, port);
+
+    // Messages are padded to 8 bytes, so each one starts aligned in the buffer
+    alignas(8) static unsigned char buffer[RECEIVE_BUFFER_SIZE];
+    std::size_t begin = 0, end = 0;
+    while (true) {
+        ssize_t n = read(sockfd, buffer + end, sizeof(buffer) - end);
+        if (n <= 0) {
+            if (n == -1) {
+                perror("read");
+            }
+            LOG_INFO("[Wire client] Server closed the connection");
+            break;
+        }
+        end += static_cast<std::size_t>(n);
+
+        long size;
+        while ((size = ipc::frame_size(buffer + begin, end - begin)) > 0 &&
+               static_cast<std::size_t>(size) <= end - begin) {
+            const flipflop::Update* update = ipc::view_message<flipflop::Update>(buffer + begin, size);
+            if (update != nullptr && update->text_count() == STRING_SIZE) {
+                uint64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+                LOG_INFO("[Wire client] Update %d from producer %d: %.*s (%lld us after publish)", update->version,
+                         update->producer_pid, static_cast<int>(update->text_count() - 1), update->text(),
+                         static_cast<long long>(now_ns - update->publish_ns) / 1000);
+            } else {
+                LOG_WARN("[Wire client] Skipping a %ld-byte message of type %u", size,
+                         static_cast<unsigned>(reinterpret_cast<const ipc::MessageHeader*>(buffer + begin)->type));
+            }
+            begin += static_cast<std::size_t>(size);
+        }
+        if (size == -1) {
+            std::cerr << "[Wire client] Corrupt message header, closing" << std::endl;
+            break;
+        }
+        // Keep a partial message at the start of the buffer for the next read
+        std::memmove(buffer, buffer + begin, end - begin);
+        end -= begin;
+        begin = 0;
+    }
+
+    close(sockfd);
+    return 0;
+}
@@ -0,0 +1,90 @@
+// journal_wake_test.cpp
+//
+// Several JournalReaders parked in read() must all wake up for one append:
+// a wake-up delivered to only one of them leaves the others asleep until
+// later records arrive.
+#include "ipc/journal.h"
+#include <dirent.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+constexpr int READERS = 3;
+constexpr auto PARK_TIME = std::chrono::milliseconds(200);  // Far beyond the readers' spin phase
+constexpr auto WAKE_DEADLINE = std::chrono::seconds(2);
+
+struct Record {
+    uint64_t value;
+};
+
+// Removes `dir` and the files in it
+static void remove_dir(const std::string& dir) {
+    if (DIR* entries = opendir(dir.c_str())) {
+        while (dirent* entry = readdir(entries)) {
+            std::string name = entry->d_name;
+            if (name != "." && name != "..") {
+                unlink((dir + "/" + name).c_str());
+            }
+        }
+        closedir(entries);
+    }
+    rmdir(dir.c_str());
+}
+
+int main() {
+    char dir[] = "/tmp/journal_wake_test.XXXXXX";
+    if (mkdtemp(dir) == nullptr) {
+        perror("mkdtemp");
+        return 1;
+    }
+    std::string path = std::string(dir) + "/journal";
+
+    ipc::JournalWriter<Record> writer;
+    if (!writer.open(path, 1024, 2)) {
+        return 1;
+    }
+
+    std::atomic<int> woken(0);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < READERS; ++i) {
+        readers.emplace_back([&path, &woken]() {
+            ipc::JournalReader<Record> reader;
+            Record record;
+            if (reader.open(path) && reader.read(record)) {
+                woken.fetch_add(1);
+            }
+        });
+    }
+    std::this_thread::sleep_for(PARK_TIME);
+
+    writer.append(Record{1});
+    auto deadline = std::chrono::steady_clock::now() + WAKE_DEADLINE;
+    while (woken.load() < READERS && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    int woken_by_one = woken.load();
+
+    // Release any reader the append failed to wake so the threads can be joined
+    for (int i = 0; i < READERS && woken.load() < READERS; ++i) {
+        writer.append(Record{2});
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    writer.close();
+    remove_dir(path);
+    rmdir(dir);
+
+    if (woken_by_one != READERS) {
+        std::fprintf(stderr, "One append woke %d of %d parked readers\n", woken_by_one, READERS);
+        return 1;
+    }
+    std::printf("One append woke all %d parked readers\n", READERS);
+    return 0;
+}
@@ -0,0 +1,116 @@
+// ipcstat.cpp
+//
+// Samples the metrics page at the end of a shared segment (include/ipc/metrics.h)
+// and prints per-producer and per-consumer rates, like vmstat for one segment.
+// The page is mapped read-only and read with plain loads, so the monitored
+// processes are never interrupted, locked or made to share a written cache line.
+//
+//   ipcstat <segment> [interval ms] [samples]   (defaults: 1000 ms, until Ctrl-C)
+#include "ipc/metrics.h"
+#include "ipc/shared_segment.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <signal.h>
+#include <thread>
+
+struct Snapshot {
+    int32_t pid;
+    uint32_t role;
+    uint64_t messages;
+    uint64_t lag;
+    uint64_t waits;
+    uint64_t spins;
+    uint64_t sleeps;
+    uint64_t overruns;
+};
+
+static void take(const ipc::MetricsPage* page, Snapshot* out) {
+    for (std::size_t i = 0; i < ipc::METRICS_SLOTS; ++i) {
+        const ipc::RoleMetrics& slot = page->slots[i];
+        out[i].pid = slot.pid.load(std::memory_order_acquire);
+        out[i].role = slot.role.load(std::memory_order_acquire);
+        out[i].messages = slot.messages.load(std::memory_order_relaxed);
+        out[i].lag = slot.lag.load(std::memory_order_relaxed);
+        out[i].waits = slot.waits.load(std::memory_order_relaxed);
+        out[i].spins = slot.spins.load(std::memory_order_relaxed);
+        out[i].sleeps = slot.sleeps.load(std::memory_order_relaxed);
+        out[i].overruns = slot.overruns.load(std::memory_order_relaxed);
+    }
+}
+
+static uint64_t rate(uint64_t now, uint64_t before, double seconds) {
+    return (now >= before) ? static_cast<uint64_t>((now - before) / seconds) : 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 4) {
+        std::cerr << "Usage: " << argv[0] << " <segment> [interval ms] [samples]\n";
+        return 1;
+    }
+    const char* name = argv[1];
+    int interval_ms = (argc > 2) ? std::atoi(argv[2]) : 1000;
+    long samples = (argc > 3) ? std::atol(argv[3]) : 0;
+    if (interval_ms <= 0) {
+        std::cerr << "Interval must be at least 1 ms\n";
+        return 1;
+    }
+
+    ipc::SharedSegment segment;
+    if (!segment.open(name, 0, true)) {
+        return 1;
+    }
+    const ipc::MetricsPage* page = ipc::metrics_page(segment);
+    if (page == nullptr || !page->valid()) {
+        std::cerr << name << " has no metrics page (or was written by a different layout version)\n";
+        return 1;
+    }
+
+    static Snapshot previous[ipc::METRICS_SLOTS];
+    static Snapshot current[ipc::METRICS_SLOTS];
+    take(page, previous);
+    auto previous_time = std::chrono::steady_clock::now();
+
+    for (long sample = 0; samples == 0 || sample < samples; ++sample) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+        take(page, current);
+        auto now = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(now - previous_time).count();
+
+        std::cout << std::left << std::setw(10) << "role" << std::right
+                  << std::setw(8) << "pid"
+                  << std::setw(12) << "msgs/s"
+                  << std::setw(14) << "total"
+                  << std::setw(8) << "lag"
+                  << std::setw(10) << "waits/s"
+                  << std::setw(10) << "spins/s"
+                  << std::setw(10) << "sleeps/s"
+                  << std::setw(10) << "overruns" << "\n";
+        for (std::size_t i = 0; i < ipc::METRICS_SLOTS; ++i) {
+            const Snapshot& s = current[i];
+            if (s.pid == 0 || s.role == ipc::METRICS_FREE || kill(s.pid, 0) == -1) {
+                continue; // Free, or left behind by a process that died
+            }
+            // A slot reclaimed by another process since the last sample starts from zero
+            Snapshot base = (previous[i].pid == s.pid) ? previous[i] : Snapshot();
+            std::cout << std::left << std::setw(10) << (s.role == ipc::METRICS_PRODUCER ? "producer" : "consumer")
+                      << std::right
+                      << std::setw(8) << s.pid
+                      << std::setw(12) << rate(s.messages, base.messages, seconds)
+                      << std::setw(14) << s.messages
+                      << std::setw(8) << s.lag
+                      << std::setw(10) << rate(s.waits, base.waits, seconds)
+                      << std::setw(10) << rate(s.spins, base.spins, seconds)
+                      << std::setw(10) << rate(s.sleeps, base.sleeps, seconds)
+                      << std::setw(10) << s.overruns << "\n";
+        }
+        std::cout << std::endl;
+
+        std::copy(current, current + ipc::METRICS_SLOTS, previous);
+        previous_time = now;
+    }
+    return 0;
+}
@@ -0,0 +1,230 @@
+// log_decoder.cpp
+//
+// Turns a binary log written by the async logger (ASYNC_LOG_BINARY=<path>)
+// back into the same text lines the logger prints in text mode.
+//
+//   log_decoder <binary-log> [more logs...]
+#include "binary_log_format.h"
+#include "log_level.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+struct Format {
+    int level;
+    std::string signature;
+    std::string fmt;
+};
+
+// Formats a single conversion spec with one argument decoded from the record
+static bool format_argument(const std::string& spec, char tag, const char*& p, const char* end, std::string& out) {
+    char buffer[512];
+    int length = 0;
+
+    if (tag == 's') {
+        uint64_t size;
+        if (!binlog::get_varint(p, end, size) || size > static_cast<uint64_t>(end - p)) {
+            return false;
+        }
+        std::string value(p, size);
+        p += size;
+        std::vector<char> big(value.size() + spec.size() + 512);
+        length = snprintf(big.data(), big.size(), spec.c_str(), value.c_str());
+        if (length > 0) {
+            out.append(big.data(), std::min(static_cast<std::size_t>(length), big.size() - 1));
+        }
+        return true;
+    }
+
+    if (tag == 'f' || tag == 'd') {
+        std::size_t size = binlog::tag_size(tag);
+        if (static_cast<std::size_t>(end - p) < size) {
+            return false;
+        }
+        double value;
+        if (tag == 'f') {
+            float f;
+            std::memcpy(&f, p, sizeof(f));
+            value = f;
+        } else {
+            std::memcpy(&value, p, sizeof(value));
+        }
+        p += size;
+        length = snprintf(buffer, sizeof(buffer), spec.c_str(), value);
+    } else {
+        uint64_t raw;
+        if (!binlog::get_varint(p, end, raw)) {
+            return false;
+        }
+        if (tag == 'p') {
+            length = snprintf(buffer, sizeof(buffer), spec.c_str(), reinterpret_cast<void*>(static_cast<uintptr_t>(raw)));
+        } else if (binlog::tag_signed(tag)) {
+            int64_t value = binlog::unzigzag(raw);
+            if (tag == 'l') {
+                length = snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<long long>(value));
+            } else {
+                length = snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<int>(value));
+            }
+        } else if (tag == 'L') {
+            length = snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<unsigned long long>(raw));
+        } else if (tag == 'I') {
+            length = snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<unsigned int>(raw));
+        } else {
+            // 8/16-bit values are promoted to int when passed to printf
+            length = snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<int>(raw));
+        }
+    }
+
+    if (length > 0) {
+        out.append(buffer, std::min(static_cast<std::size_t>(length), sizeof(buffer) - 1));
+    }
+    return true;
+}
+
+// Applies a printf format to the arguments of one record, one conversion at a time
+static bool format_record(const Format& format, const char*& p, const char* end, std::string& out) {
+    const std::string& fmt = format.fmt;
+    std::size_t next_arg = 0;
+
+    for (std::size_t i = 0; i < fmt.size(); ++i) {
+        if (fmt[i] != '%') {
+            out += fmt[i];
+            continue;
+        }
+        if (i + 1 < fmt.size() && fmt[i + 1] == '%') {
+            out += '%';
+            ++i;
+            continue;
+        }
+
+        std::size_t start = i++;
+        while (i < fmt.size() && std::strchr("-+ #0123456789.hljztL", fmt[i]) != nullptr) {
+            ++i;
+        }
+        if (i >= fmt.size() || next_arg >= format.signature.size()) {
+            out.append(fmt, start, std::string::npos);
+            break;
+        }
+        if (!format_argument(fmt.substr(start, i - start + 1), format.signature[next_arg++], p, end, out)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void append_prefix(std::string& out, int64_t epoch_ns, uint64_t thread_id, int level) {
+    time_t second = static_cast<time_t>(epoch_ns / 1000000000);
+    struct tm timeinfo;
+    localtime_r(&second, &timeinfo);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", &timeinfo);
+    char prefix[128];
+    snprintf(prefix, sizeof(prefix), "[%s.%03d][Thread-%llu][%s] ", date,
+             static_cast<int>((epoch_ns / 1000000) % 1000), static_cast<unsigned long long>(thread_id),
+             log_level_name(level));
+    out += prefix;
+}
+
+static bool decode_file(const char* path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Cannot open " << path << "\n";
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    binlog::FileHeader header;
+    if (data.size() < sizeof(header)) {
+        std::cerr << path << ": too short for a binary log\n";
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, binlog::MAGIC, sizeof(header.magic)) != 0 || header.version != binlog::VERSION) {
+        std::cerr << path << ": not a binary log (bad magic or version)\n";
+        return false;
+    }
+
+    std::map<uint64_t, Format> formats;
+    std::map<uint64_t, uint64_t> threads;
+    uint64_t tsc = header.tsc_base;
+    std::string out;
+
+    const char* p = data.data() + sizeof(header);
+    const char* end = data.data() + data.size();
+    bool truncated = false;
+    while (p < end) {
+        uint8_t tag = static_cast<uint8_t>(*p++);
+        uint64_t a, b, c;
+
+        if (tag == binlog::TAG_FORMAT) {
+            Format format;
+            uint64_t length;
+            if (!binlog::get_varint(p, end, a) || p >= end) { truncated = true; break; }
+            format.level = static_cast<uint8_t>(*p++);
+            if (!binlog::get_varint(p, end, length) || length > static_cast<uint64_t>(end - p)) { truncated = true; break; }
+            format.signature.assign(p, length);
+            p += length;
+            if (!binlog::get_varint(p, end, length) || length > static_cast<uint64_t>(end - p)) { truncated = true; break; }
+            format.fmt.assign(p, length);
+            p += length;
+            formats[a] = format;
+        } else if (tag == binlog::TAG_THREAD) {
+            if (!binlog::get_varint(p, end, a) || !binlog::get_varint(p, end, b)) { truncated = true; break; }
+            threads[a] = b;
+        } else if (tag == binlog::TAG_DROPS) {
+            if (!binlog::get_varint(p, end, a) || !binlog::get_varint(p, end, b)) { truncated = true; break; }
+            int64_t epoch_ns = header.epoch_ns_base + static_cast<int64_t>(
+                static_cast<double>(static_cast<int64_t>(tsc - header.tsc_base)) * header.ns_per_tick);
+            append_prefix(out, epoch_ns, threads[a], LOG_LEVEL_WARN);
+            out += "[async_log] " + std::to_string(b) + " records dropped, thread buffer full\n";
+        } else if (tag == binlog::TAG_RECORD) {
+            if (!binlog::get_varint(p, end, a) || !binlog::get_varint(p, end, b) || !binlog::get_varint(p, end, c)) { truncated = true; break; }
+            tsc += static_cast<uint64_t>(binlog::unzigzag(c));
+            std::map<uint64_t, Format>::const_iterator format = formats.find(a);
+            if (format == formats.end()) {
+                std::cerr << path << ": record refers to unknown format " << a << "\n";
+                return false;
+            }
+            int64_t epoch_ns = header.epoch_ns_base + static_cast<int64_t>(
+                static_cast<double>(static_cast<int64_t>(tsc - header.tsc_base)) * header.ns_per_tick);
+            append_prefix(out, epoch_ns, threads[b], format->second.level);
+            if (!format_record(format->second, p, end, out)) { truncated = true; break; }
+            out += '\n';
+        } else {
+            std::cerr << path << ": corrupt entry tag " << static_cast<int>(tag) << "\n";
+            std::cout << out;
+            return false;
+        }
+
+        if (out.size() > (1 << 16)) {
+            std::cout << out;
+            out.clear();
+        }
+    }
+
+    std::cout << out;
+    if (truncated) {
+        std::cerr << path << ": truncated entry at end of file\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <binary-log> [more logs...]\n";
+        return 1;
+    }
+    bool ok = true;
+    for (int i = 1; i < argc; ++i) {
+        ok &= decode_file(argv[i]);
+    }
+    return ok ? 0 : 1;
+}
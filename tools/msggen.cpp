@@ -0,0 +1,395 @@
+// msggen.cpp
+//
+// Compiles a message schema into a header of fixed-layout structs
+// (include/ipc/message.h) that are read in place from shared memory slots
+// and TCP receive buffers, with no parsing step. Run by the build through
+// ipc_add_messages() in tools/CMakeLists.txt.
+//
+//   msggen <schema> <output header>
+//
+// Schema syntax, one declaration per line, `#` starts a comment:
+//
+//   namespace wire
+//   # Comment lines right before a message become its doc comment
+//   message FlipFlopUpdate 1 version 1     # name, type id, layout version
+//       u64 publish_ns                     # fields, in wire order
+//       char symbol[8]                     # fixed-size arrays
+//       tail char text                     # optional variable-length tail, last
+//   end
+//
+// Field types: i8 u8 i16 u16 i32 u32 i64 u64 f32 f64 char. Every field is
+// placed at its natural alignment behind the 16-byte ipc::MessageHeader;
+// gaps become explicit padding and the fixed part is rounded up to 8 bytes,
+// so the layout is the same for every compiler and the tail stays aligned.
+// To evolve a message, append fields and bump its version. Field names may not
+// clash with generated members: header, TYPE, VERSION, init, size_for, pad_*,
+// the message name, or <tail>_count. No name may be a C++ keyword or an
+// identifier reserved to the implementation (_Upper..., anything with __).
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+constexpr std::size_t HEADER_SIZE = 16; // sizeof(ipc::MessageHeader)
+constexpr std::size_t MAX_FIXED_SIZE = 65536;
+
+struct FieldType {
+    const char* cpp;
+    std::size_t size;
+};
+
+static const std::map<std::string, FieldType>& field_types() {
+    static const std::map<std::string, FieldType> types = {
+        {"i8", {"int8_t", 1}},    {"u8", {"uint8_t", 1}},   {"char", {"char", 1}},
+        {"i16", {"int16_t", 2}},  {"u16", {"uint16_t", 2}},
+        {"i32", {"int32_t", 4}},  {"u32", {"uint32_t", 4}}, {"f32", {"float", 4}},
+        {"i64", {"int64_t", 8}},  {"u64", {"uint64_t", 8}}, {"f64", {"double", 8}},
+    };
+    return types;
+}
+
+struct Field {
+    std::string type;
+    std::string name;
+    std::size_t count;  // Array length, 1 for scalars
+    std::size_t offset;
+    std::string comment;
+};
+
+struct Message {
+    std::string name;
+    unsigned long type_id;
+    unsigned long version;
+    std::vector<std::string> doc;
+    std::vector<Field> fields;
+    bool has_tail;
+    Field tail;
+    std::size_t fixed_size;
+    int line;
+};
+
+struct Schema {
+    std::string path;
+    std::string ns;
+    std::vector<Message> messages;
+};
+
+static bool is_identifier(const std::string& text) {
+    if (text.empty() || !(std::isalpha(static_cast<unsigned char>(text[0])) || text[0] == '_')) {
+        return false;
+    }
+    for (char c : text) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Names that compile to something other than a plain identifier
+static bool cpp_reserved(const std::string& name) {
+    static const std::set<std::string> keywords = {
+        "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case",
+        "catch", "char", "char8_t", "char16_t", "char32_t", "class", "compl", "concept", "const", "consteval",
+        "constexpr", "constinit", "const_cast", "continue", "co_await", "co_return", "co_yield", "decltype",
+        "default", "delete", "do", "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern",
+        "false", "float", "for", "friend", "goto", "if", "inline", "int", "long", "mutable", "namespace", "new",
+        "noexcept", "not", "not_eq", "nullptr", "operator", "or", "or_eq", "private", "protected", "public",
+        "register", "reinterpret_cast", "requires", "return", "short", "signed", "sizeof", "static",
+        "static_assert", "static_cast", "struct", "switch", "template", "this", "thread_local", "throw", "true",
+        "try", "typedef", "typeid", "typename", "union", "unsigned", "using", "virtual", "void", "volatile",
+        "wchar_t", "while", "xor", "xor_eq",
+    };
+    bool underscore_upper = name.size() > 1 && name[0] == '_' && std::isupper(static_cast<unsigned char>(name[1]));
+    return keywords.count(name) != 0 || underscore_upper || name.find("__") != std::string::npos;
+}
+
+static std::string trim(const std::string& text) {
+    std::size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    return text.substr(begin, text.find_last_not_of(" \t\r") - begin + 1);
+}
+
+class Parser {
+public:
+    explicit Parser(Schema& schema) : schema_(schema), line_(0), current_(nullptr) {}
+
+    bool parse(std::istream& in) {
+        std::string raw;
+        std::vector<std::string> pending_doc;
+        while (std::getline(in, raw)) {
+            ++line_;
+            std::size_t hash = raw.find('#');
+            std::string comment = hash == std::string::npos ? "" : trim(raw.substr(hash + 1));
+            std::string text = trim(raw.substr(0, hash));
+            if (text.empty()) {
+                if (hash != std::string::npos && current_ == nullptr) {
+                    pending_doc.push_back(comment);
+                } else {
+                    pending_doc.clear();
+                }
+                continue;
+            }
+            std::istringstream words(text);
+            std::vector<std::string> tokens;
+            for (std::string word; words >> word;) {
+                tokens.push_back(word);
+            }
+            bool ok = current_ == nullptr ? top_level(tokens, pending_doc) : member(tokens, comment);
+            if (!ok) {
+                return false;
+            }
+            pending_doc.clear();
+        }
+        if (current_ != nullptr) {
+            return error("message " + current_->name + " has no `end`");
+        }
+        if (schema_.messages.empty()) {
+            return error("no messages");
+        }
+        return true;
+    }
+
+private:
+    bool error(const std::string& what) {
+        std::cerr << schema_.path << ":" << line_ << ": " << what << "\n";
+        return false;
+    }
+
+    bool top_level(const std::vector<std::string>& tokens, const std::vector<std::string>& doc) {
+        if (tokens[0] == "namespace" && tokens.size() == 2 && is_identifier(tokens[1])) {
+            if (cpp_reserved(tokens[1])) {
+                return error("namespace `" + tokens[1] + "` is a C++ keyword or reserved identifier");
+            }
+            schema_.ns = tokens[1];
+            return true;
+        }
+        if (tokens[0] != "message" || tokens.size() != 5 || tokens[3] != "version") {
+            return error("expected `message <Name> <type id> version <n>` or `namespace <name>`");
+        }
+        Message message;
+        message.name = tokens[1];
+        message.type_id = std::strtoul(tokens[2].c_str(), nullptr, 10);
+        message.version = std::strtoul(tokens[4].c_str(), nullptr, 10);
+        message.doc = doc;
+        message.has_tail = false;
+        message.fixed_size = HEADER_SIZE;
+        message.line = line_;
+        if (!is_identifier(message.name)) {
+            return error("invalid message name `" + message.name + "`");
+        }
+        if (cpp_reserved(message.name)) {
+            return error("message name `" + message.name + "` is a C++ keyword or reserved identifier");
+        }
+        if (message.type_id == 0 || message.type_id > 0xFFFF || message.version == 0 || message.version > 0xFFFF) {
+            return error("type id and version must be in 1..65535");
+        }
+        for (const Message& other : schema_.messages) {
+            if (other.name == message.name || other.type_id == message.type_id) {
+                return error("message " + message.name + " reuses the name or type id of " + other.name);
+            }
+        }
+        schema_.messages.push_back(message);
+        current_ = &schema_.messages.back();
+        return true;
+    }
+
+    bool member(const std::vector<std::string>& tokens, const std::string& comment) {
+        if (tokens.size() == 1 && tokens[0] == "end") {
+            current_->fixed_size = (current_->fixed_size + 7) / 8 * 8;
+            current_ = nullptr;
+            return true;
+        }
+        if (current_->has_tail) {
+            return error("the tail must be the last member of " + current_->name);
+        }
+        bool tail = tokens[0] == "tail";
+        if (tokens.size() != (tail ? 3u : 2u)) {
+            return error("expected `<type> <name>`, `<type> <name>[<n>]` or `tail <type> <name>`");
+        }
+        Field field;
+        field.type = tokens[tail ? 1 : 0];
+        field.name = tokens[tail ? 2 : 1];
+        field.count = 1;
+        field.comment = comment;
+        std::size_t bracket = field.name.find('[');
+        if (bracket != std::string::npos && !tail && field.name.back() == ']') {
+            field.count = std::strtoul(field.name.c_str() + bracket + 1, nullptr, 10);
+            field.name = field.name.substr(0, bracket);
+            if (field.count == 0) {
+                return error("array length must be positive");
+            }
+        }
+        std::map<std::string, FieldType>::const_iterator type = field_types().find(field.type);
+        if (type == field_types().end()) {
+            return error("unknown type `" + field.type + "`");
+        }
+        if (!is_identifier(field.name) || reserved(field.name)) {
+            return error("invalid or reserved field name `" + field.name + "`");
+        }
+        if (cpp_reserved(field.name)) {
+            return error("field name `" + field.name + "` is a C++ keyword or reserved identifier");
+        }
+        for (const Field& other : current_->fields) {
+            if (other.name == field.name) {
+                return error("duplicate field `" + field.name + "`");
+            }
+            if (tail && other.name == field.name + "_count") {
+                return error("field `" + other.name + "` clashes with the tail's generated " + other.name + "()");
+            }
+        }
+
+        if (tail) {
+            current_->has_tail = true;
+            current_->tail = field;
+            return true;
+        }
+        std::size_t align = type->second.size;
+        field.offset = (current_->fixed_size + align - 1) / align * align;
+        current_->fixed_size = field.offset + type->second.size * field.count;
+        if (current_->fixed_size > MAX_FIXED_SIZE) {
+            return error("message " + current_->name + " is larger than 64 KiB");
+        }
+        current_->fields.push_back(field);
+        return true;
+    }
+
+    // Names the generated struct already uses
+    bool reserved(const std::string& name) const {
+        return name == "header" || name == "init" || name == "size_for" || name == "TYPE" || name == "VERSION" ||
+               name == current_->name || name.compare(0, 4, "pad_") == 0;
+    }
+
+    Schema& schema_;
+    int line_;
+    Message* current_;
+};
+
+static void emit_padding(std::ostream& out, std::size_t from, std::size_t to) {
+    if (to > from) {
+        out << "    uint8_t pad_" << from << "[" << (to - from) << "];\n";
+    }
+}
+
+static void emit_message(std::ostream& out, const Message& m) {
+    for (const std::string& line : m.doc) {
+        out << "// " << line << "\n";
+    }
+    out << "struct " << m.name << " {\n"
+        << "    static constexpr uint16_t TYPE = " << m.type_id << ";\n"
+        << "    static constexpr uint16_t VERSION = " << m.version << ";\n\n"
+        << "    ipc::MessageHeader header;\n";
+    std::size_t end = HEADER_SIZE;
+    for (const Field& f : m.fields) {
+        emit_padding(out, end, f.offset);
+        const FieldType& type = field_types().at(f.type);
+        std::ostringstream declaration;
+        declaration << type.cpp << " " << f.name;
+        if (f.count != 1) {
+            declaration << "[" << f.count << "]";
+        }
+        declaration << ";";
+        out << "    " << declaration.str() << std::string(declaration.str().size() < 28 ? 28 - declaration.str().size() : 1, ' ')
+            << "// @" << f.offset << (f.comment.empty() ? "" : ": " + f.comment) << "\n";
+        end = f.offset + type.size * f.count;
+    }
+    emit_padding(out, end, m.fixed_size);
+
+    std::string tail_type = m.has_tail ? field_types().at(m.tail.type).cpp : "";
+    std::string count = m.has_tail ? m.tail.name + "_count" : "";
+    out << "\n    /// Bytes needed for this message" << (m.has_tail ? " with `" + count + "` tail elements" : "") << ".\n"
+        << "    static constexpr std::size_t size_for(" << (m.has_tail ? "std::size_t " + count : "") << ") {\n"
+        << "        return sizeof(" << m.name << ")" << (m.has_tail ? " + " + count + " * sizeof(" + tail_type + ")" : "")
+        << ";\n    }\n\n"
+        << "    /// Fills in the header; the fields" << (m.has_tail ? " and the tail" : "") << " are left to the caller.\n"
+        << "    void init(" << (m.has_tail ? "std::size_t " + count + " = 0" : "") << ") {\n"
+        << "        header.size = static_cast<uint32_t>(size_for(" << (m.has_tail ? count : "") << "));\n"
+        << "        header.type = TYPE;\n"
+        << "        header.version = VERSION;\n"
+        << "        header.fixed_size = sizeof(" << m.name << ");\n"
+        << "        header.reserved = 0;\n"
+        << "    }\n";
+    if (m.has_tail) {
+        const std::string& t = m.tail.name;
+        out << "\n    /// Variable-length tail" << (m.tail.comment.empty() ? "" : ": " + m.tail.comment)
+            << ". Starts at header.fixed_size, which a newer writer may have grown.\n"
+            << "    " << tail_type << "* " << t << "() {\n"
+            << "        return reinterpret_cast<" << tail_type << "*>(reinterpret_cast<unsigned char*>(this) + header.fixed_size);\n"
+            << "    }\n"
+            << "    const " << tail_type << "* " << t << "() const {\n"
+            << "        return reinterpret_cast<const " << tail_type
+            << "*>(reinterpret_cast<const unsigned char*>(this) + header.fixed_size);\n"
+            << "    }\n"
+            << "    std::size_t " << count << "() const { return (header.size - header.fixed_size) / sizeof("
+            << tail_type << "); }\n";
+    }
+    out << "};\n\n";
+
+    for (const Field& f : m.fields) {
+        out << "static_assert(offsetof(" << m.name << ", " << f.name << ") == " << f.offset << ", \"" << m.name << "::"
+            << f.name << " moved\");\n";
+    }
+    out << "static_assert(sizeof(" << m.name << ") == " << m.fixed_size << ", \"" << m.name
+        << " changed size\");\n"
+        << "static_assert(std::is_trivially_copyable<" << m.name << ">::value && std::is_standard_layout<" << m.name
+        << ">::value,\n              \"" << m.name << " is read in place from shared memory and sockets\");\n\n";
+}
+
+static std::string guard_for(const std::string& path) {
+    std::size_t slash = path.find_last_of('/');
+    std::string guard;
+    for (char c : path.substr(slash == std::string::npos ? 0 : slash + 1)) {
+        guard += std::isalnum(static_cast<unsigned char>(c)) ? static_cast<char>(std::toupper(c)) : '_';
+    }
+    return "GENERATED_" + guard;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <schema> <output header>\n";
+        return 1;
+    }
+    Schema schema;
+    schema.path = argv[1];
+    std::ifstream in(argv[1]);
+    if (!in) {
+        std::cerr << "Cannot open " << argv[1] << "\n";
+        return 1;
+    }
+    Parser parser(schema);
+    if (!parser.parse(in)) {
+        return 1;
+    }
+
+    std::ostringstream out;
+    std::string guard = guard_for(argv[2]);
+    std::string schema_name = schema.path.substr(schema.path.find_last_of('/') + 1);
+    out << "// Generated by tools/msggen from " << schema_name << ". Do not edit.\n"
+        << "#ifndef " << guard << "\n#define " << guard << "\n\n"
+        << "#include \"ipc/message.h\"\n"
+        << "#include <cstddef>\n#include <cstdint>\n#include <type_traits>\n\n";
+    if (!schema.ns.empty()) {
+        out << "namespace " << schema.ns << " {\n\n";
+    }
+    for (const Message& message : schema.messages) {
+        emit_message(out, message);
+    }
+    if (!schema.ns.empty()) {
+        out << "} // namespace " << schema.ns << "\n\n";
+    }
+    out << "#endif\n";
+
+    std::ofstream file(argv[2]);
+    if (!(file << out.str())) {
+        std::cerr << "Cannot write " << argv[2] << "\n";
+        return 1;
+    }
+    return 0;
+}
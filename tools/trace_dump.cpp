@@ -0,0 +1,79 @@
+// trace_dump.cpp
+//
+// Converts the shared trace segment written by TRACE_SPAN (IPC_TRACE=<name>)
+// to Chrome/Perfetto JSON. Open the output in ui.perfetto.dev or
+// chrome://tracing. The traced processes may keep running while it reads.
+//
+//   trace_dump [segment] [output.json]   (defaults: /ipc_trace, stdout)
+//   trace_dump --unlink [segment]
+#include "trace.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr const char* DEFAULT_SEGMENT = "/ipc_trace";
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::strcmp(argv[1], "--unlink") == 0) {
+        const char* name = (argc > 2) ? argv[2] : DEFAULT_SEGMENT;
+        if (shm_unlink(name) == -1) {
+            perror("shm_unlink");
+            return 1;
+        }
+        std::cerr << "Removed trace segment " << name << "\n";
+        return 0;
+    }
+    if (argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " [segment] [output.json]\n"
+                  << "       " << argv[0] << " --unlink [segment]\n";
+        return 1;
+    }
+    const char* name = (argc > 1) ? argv[1] : DEFAULT_SEGMENT;
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd == -1) {
+        perror("shm_open");
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size < static_cast<off_t>(sizeof(trace::TraceSegment))) {
+        std::cerr << name << " is not a trace segment (wrong size)\n";
+        close(fd);
+        return 1;
+    }
+    void* ptr = mmap(nullptr, sizeof(trace::TraceSegment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    const auto* segment = reinterpret_cast<const trace::TraceSegment*>(ptr);
+    if (!segment->valid()) {
+        std::cerr << name << " is not a trace segment (bad magic or version)\n";
+        munmap(ptr, sizeof(trace::TraceSegment));
+        return 1;
+    }
+
+    FILE* out = stdout;
+    if (argc > 2) {
+        out = std::fopen(argv[2], "w");
+        if (out == nullptr) {
+            perror("fopen");
+            munmap(ptr, sizeof(trace::TraceSegment));
+            return 1;
+        }
+    }
+
+    uint64_t events = trace::write_chrome_trace(*segment, out);
+    bool ok = std::fflush(out) == 0;
+    if (out != stdout) {
+        ok = (std::fclose(out) == 0) && ok;
+    }
+    munmap(ptr, sizeof(trace::TraceSegment));
+    std::cerr << "Wrote " << events << " spans from " << name << "\n";
+    return ok ? 0 : 1;
+}